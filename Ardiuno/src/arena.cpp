@@ -0,0 +1,85 @@
+#include "arena.h"
+
+static byte commandBuffer[COMMAND_ARENA_SIZE];
+static byte filterBuffer[FILTER_ARENA_SIZE];
+const unsigned int arenaRamBytes = sizeof(commandBuffer) + sizeof(filterBuffer);
+
+ArenaAllocator commandArena(commandBuffer, sizeof(commandBuffer));
+ArenaAllocator filterArena(filterBuffer, sizeof(filterBuffer));
+
+// Keep every block aligned for the pointers ArduinoJson stores in it
+static size_t aligned(size_t size) {
+  return (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+}
+
+ArenaAllocator::ArenaAllocator(byte *buffer, size_t size)
+    : buffer_(buffer),
+      size_(size),
+      used_(0),
+      peak_(0),
+      lastOffset_(0),
+      failures_(0) {}
+
+void *ArenaAllocator::allocate(size_t size) {
+  size = aligned(size);
+  if (size > size_ - used_) {
+    failures_++;
+    return NULL;
+  }
+  lastOffset_ = used_;
+  used_ += size;
+  if (used_ > peak_) peak_ = used_;
+  return buffer_ + lastOffset_;
+}
+
+void ArenaAllocator::deallocate(void *pointer) {
+  // Only the newest block can be handed back; the rest waits for reset()
+  if (pointer == buffer_ + lastOffset_ && used_ > 0) {
+    used_ = lastOffset_;
+  }
+}
+
+// The newest block grows or shrinks in place (ArduinoJson does this with the
+// string it is reading and when it trims its pools). Older blocks are copied
+// to a new one, which is always at least as big as the data it holds
+void *ArenaAllocator::reallocate(void *pointer, size_t newSize) {
+  if (pointer == NULL) return allocate(newSize);
+
+  if (pointer == buffer_ + lastOffset_) {
+    newSize = aligned(newSize);
+    if (newSize > size_ - lastOffset_) {
+      failures_++;
+      return NULL;
+    }
+    used_ = lastOffset_ + newSize;
+    if (used_ > peak_) peak_ = used_;
+    return pointer;
+  }
+
+  // Old blocks sit below the newest one, so this never reads past it
+  size_t available = (buffer_ + lastOffset_) - (byte *)pointer;
+  byte *moved = (byte *)allocate(newSize);
+  if (moved) {
+    memcpy(moved, pointer, min(newSize, available));
+  }
+  return moved;
+}
+
+void ArenaAllocator::reset() {
+  used_ = 0;
+  lastOffset_ = 0;
+}
+
+size_t ArenaAllocator::used() const {
+  return used_;
+}
+
+// Most the arena has held at once since power-up
+size_t ArenaAllocator::peak() const {
+  return peak_;
+}
+
+// Requests refused because the arena was full
+unsigned int ArenaAllocator::failures() const {
+  return failures_;
+}
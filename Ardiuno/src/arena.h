@@ -0,0 +1,44 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "hal.h"
+#include <ArduinoJson.h>
+
+// Fixed RAM for the JSON documents, so ArduinoJson never touches the heap
+#define COMMAND_ARENA_SIZE 384  // One parsed (filtered) command at a time
+#define FILTER_ARENA_SIZE 256   // The command key filter, built once
+
+// Bump allocator over a caller-owned buffer for ArduinoJson. Blocks are never
+// freed one by one - reset() drops everything once the document is gone.
+// A request that does not fit returns NULL, which ArduinoJson reports as
+// DeserializationError::NoMemory
+class ArenaAllocator : public Allocator {
+ public:
+  ArenaAllocator(byte *buffer, size_t size);
+
+  void *allocate(size_t size) override;
+  void deallocate(void *pointer) override;
+  void *reallocate(void *pointer, size_t newSize) override;
+
+  void reset();
+  size_t used() const;
+  size_t peak() const;
+  unsigned int failures() const;
+
+ private:
+  byte *buffer_;
+  size_t size_;
+  size_t used_;
+  size_t peak_;
+  size_t lastOffset_;  // Start of the newest block, which can grow in place
+  unsigned int failures_;
+};
+
+// Shared allocators for command parsing (see communication.cpp)
+extern ArenaAllocator commandArena;
+extern ArenaAllocator filterArena;
+
+// Static RAM behind both arenas (memory report)
+extern const unsigned int arenaRamBytes;
+
+#endif
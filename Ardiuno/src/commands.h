@@ -0,0 +1,101 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include "hal.h"
+
+// Handlers shared by the legacy, short JSON and long JSON command formats
+enum CommandId {
+  CMD_HELLO,
+  CMD_LINK_TEST,
+  CMD_VACUUM,
+  CMD_MOP,
+  CMD_PUMP,
+  CMD_MODE,
+  CMD_MOVE,
+  CMD_MULTI,
+  CMD_STATUS,      // Full status report
+  CMD_MEMORY,      // RAM and stack report
+  CMD_SHOW_STATE,  // Show the system state on the RGB LED
+  CMD_EMERGENCY,
+  CMD_CALIBRATE,
+  CMD_LED_TEST,
+  CMD_PULSE
+};
+
+// Formats a command name is valid in
+#define FORMAT_LEGACY 0x01  // Uppercased text, e.g. "V_ON"
+#define FORMAT_SHORT 0x02   // {"a":"v","s":1}
+#define FORMAT_LONG 0x04    // {"action":"v","state":1}
+
+#define COMMAND_NAME_LENGTH 14  // Longest name ("HELLO ARDUINO") plus '\0'
+
+// One dispatch table row. Legacy names carry their argument in the name
+// (V_ON is vacuum with 1, F is move with 'f'); JSON reads it from the payload
+struct CommandName {
+  char name[COMMAND_NAME_LENGTH];
+  byte id;
+  byte formats;
+  byte arg;
+};
+
+// Every command name, sorted by strcmp so lookups can binary search
+static constexpr CommandName commandTable[] PROGMEM = {
+    {"AUTO", CMD_MODE, FORMAT_LEGACY, 'a'},
+    {"B", CMD_MOVE, FORMAT_LEGACY, 'b'},
+    {"CALIBRATE", CMD_CALIBRATE, FORMAT_LEGACY, 0},
+    {"COVERAGE", CMD_MODE, FORMAT_LEGACY, 'c'},
+    {"F", CMD_MOVE, FORMAT_LEGACY, 'f'},
+    {"HELLO ARDUINO", CMD_HELLO, FORMAT_LEGACY, 0},
+    {"L", CMD_MOVE, FORMAT_LEGACY, 'l'},
+    {"LED", CMD_LED_TEST, FORMAT_LEGACY, 0},
+    {"MANUAL", CMD_MODE, FORMAT_LEGACY, 'm'},
+    {"MEMORY", CMD_MEMORY, FORMAT_LEGACY, 0},
+    {"M_OFF", CMD_MOP, FORMAT_LEGACY, 0},
+    {"M_ON", CMD_MOP, FORMAT_LEGACY, 1},
+    {"PULSE", CMD_PULSE, FORMAT_LEGACY, 0},
+    {"P_OFF", CMD_PUMP, FORMAT_LEGACY, 0},
+    {"P_ON", CMD_PUMP, FORMAT_LEGACY, 1},
+    {"R", CMD_MOVE, FORMAT_LEGACY, 'r'},
+    {"S", CMD_MOVE, FORMAT_LEGACY, 's'},
+    {"STATUS", CMD_SHOW_STATE, FORMAT_LEGACY, 0},
+    {"TEST", CMD_LINK_TEST, FORMAT_LEGACY, 0},
+    {"V_OFF", CMD_VACUUM, FORMAT_LEGACY, 0},
+    {"V_ON", CMD_VACUUM, FORMAT_LEGACY, 1},
+    {"cal", CMD_CALIBRATE, FORMAT_SHORT, 0},
+    {"e", CMD_EMERGENCY, FORMAT_SHORT, 0},
+    {"emergency", CMD_EMERGENCY, FORMAT_LONG, 0},
+    {"m", CMD_MOP, FORMAT_LONG, 0},
+    {"mem", CMD_MEMORY, FORMAT_SHORT, 0},
+    {"memory", CMD_MEMORY, FORMAT_LONG, 0},
+    {"mode", CMD_MODE, FORMAT_LONG, 0},
+    {"move", CMD_MOVE, FORMAT_LONG, 0},
+    {"mp", CMD_MOP, FORMAT_SHORT, 0},
+    {"mu", CMD_MULTI, FORMAT_SHORT, 0},
+    {"multi", CMD_MULTI, FORMAT_LONG, 0},
+    {"mv", CMD_MOVE, FORMAT_SHORT, 0},
+    {"o", CMD_MODE, FORMAT_SHORT, 0},
+    {"p", CMD_PUMP, FORMAT_SHORT | FORMAT_LONG, 0},
+    {"s", CMD_STATUS, FORMAT_SHORT, 0},
+    {"status", CMD_STATUS, FORMAT_LONG, 0},
+    {"t", CMD_LED_TEST, FORMAT_SHORT, 0},
+    {"test", CMD_LED_TEST, FORMAT_LONG, 0},
+    {"v", CMD_VACUUM, FORMAT_SHORT | FORMAT_LONG, 0},
+};
+
+#define COMMAND_COUNT (sizeof(commandTable) / sizeof(commandTable[0]))
+
+// Compile-time check that the table really is sorted
+constexpr int compareNames(const char *a, const char *b) {
+  return *a != *b ? (*a < *b ? -1 : 1)
+                  : (*a == '\0' ? 0 : compareNames(a + 1, b + 1));
+}
+
+constexpr bool namesSorted(const CommandName *table, unsigned int count) {
+  return count < 2 || (compareNames(table[0].name, table[1].name) < 0 &&
+                       namesSorted(table + 1, count - 1));
+}
+
+static_assert(namesSorted(commandTable, COMMAND_COUNT),
+              "commandTable must be sorted by name for the binary search");
+
+#endif
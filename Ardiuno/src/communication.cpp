@@ -1,441 +1,446 @@
 #include "communication.h"
+#include "arena.h"
+#include "commands.h"
 #include "config.h"
+#include "log.h"
+#include "mapping.h"
+#include "memory.h"
+#include "motion.h"
 #include "motors.h"
+#include "navigation.h"
+#include "outputs.h"
+#include "power.h"
 #include "rgb_led.h"
-
-// Process BLE commands from the mobile app
-void processBLECommand(String command) {
-  Serial.println("🔄 Processing BLE Command: " + command);
-  Serial.println("📏 Command Length: " + String(command.length()) + " chars");
-
-  // Check if the command is in JSON format
-  if (isValidJson(command)) {
-    Serial.println("✅ Valid JSON detected - processing JSON command");
-    processJsonCommand(command);
+#include "scheduler.h"
+#include "sensors.h"
+
+// Where a command's arguments come from
+struct CommandContext {
+  JsonDocument *doc;  // Parsed payload, NULL for legacy text commands
+  bool longFormat;    // "state"/"direction"/"type" keys instead of "s"/"d"/"t"
+  byte arg;           // Argument implied by a legacy name (see commands.h)
+};
+
+static bool runCommand(const char *name, byte format,
+                       const CommandContext &context);
+
+// Process one BLE command frame from the mobile app. The buffer is the
+// receiver's frame and may be modified (legacy commands are uppercased)
+void processBLECommand(char *command) {
+  LOG_DEBUG(MSG_BLE_COMMAND, command, strlen(command));
+
+  // JSON commands always start with '{' - parse them exactly once
+  const char *start = command;
+  while (*start == ' ') start++;
+  if (*start == '{') {
+    processJsonCommand(start);
     return;
   }
 
   // Legacy command processing (uppercase)
-  command.toUpperCase();
-  currentCommand = command;
-  Serial.println("🔤 Processing legacy command: '" + command + "'");
-  Serial3.println("ACK:" + command);
-
-  if (command == "HELLO ARDUINO") {
-    Serial.println("✅ Hello Arduino received!");
-    Serial3.println("Hello Flutter App!");
-  } else if (command == "TEST") {
-    Serial.println("✅ Connection test successful!");
-    Serial3.println("TEST_OK");
-  } else if (command == "V_ON") {
-    startVacuum();
-    showSystemState();  // Update LED to show cleaning active
-    Serial3.println("VACUUM_ON");
-  } else if (command == "V_OFF") {
-    stopVacuum();
-    showSystemState();  // Update LED to show cleaning inactive
-    Serial3.println("VACUUM_OFF");
-  } else if (command == "M_ON") {
-    startMop();
-    showSystemState();  // Update LED to show cleaning active
-    Serial3.println("MOP_ON");
-  } else if (command == "M_OFF") {
-    stopMop();
-    showSystemState();  // Update LED to show cleaning inactive
-    Serial3.println("MOP_OFF");
-  } else if (command == "P_ON") {
-    startPump();
-    showSystemState();  // Update LED to show cleaning active
-    Serial3.println("PUMP_ON");
-  } else if (command == "P_OFF") {
-    stopPump();
-    showSystemState();  // Update LED to show cleaning inactive
-    Serial3.println("PUMP_OFF");
-  } else if (command == "AUTO") {
-    autoMode = true;
-    showSystemState();  // Update LED for auto mode
-    Serial.println("✅ Autonomous mode activated");
-    Serial3.println("AUTO_MODE_ON");
-  } else if (command == "MANUAL") {
-    autoMode = false;
-    stopMotors();
-    showSystemState();  // Update LED for manual mode
-    Serial.println("✅ Manual mode activated");
-    Serial3.println("MANUAL_MODE_ON");
-  } else if (command == "F" && !autoMode) {
-    moveForward();
-    Serial.println("✅ Moving forward");
-    Serial3.println("MOVING_FORWARD");
-  } else if (command == "B" && !autoMode) {
-    moveBackward();
-    Serial.println("✅ Moving backward");
-    Serial3.println("MOVING_BACKWARD");
-  } else if (command == "L" && !autoMode) {
-    turnLeft();
-    Serial.println("✅ Turning left");
-    Serial3.println("TURNING_LEFT");
-  } else if (command == "R" && !autoMode) {
-    turnRight();
-    Serial.println("✅ Turning right");
-    Serial3.println("TURNING_RIGHT");
-  } else if (command == "S") {
-    stopMotors();
-    Serial.println("✅ Stopped");
-    Serial3.println("STOPPED");
-  } else if (command == "LED") {
-    blinkGreenLED();
-    Serial.println("✅ LED command - Green blink");
-    Serial3.println("LED_BLINK_GREEN");
-  } else if (command == "PULSE") {
-    pulseBlue();
-    Serial.println("✅ Blue pulse effect");
-    Serial3.println("PULSE_EFFECT");
-  } else if (command == "STATUS") {
-    showSystemState();
-    Serial.println("✅ System status display");
-    Serial3.println("STATUS_DISPLAY");
-  } else {
-    Serial.println("❌ Unknown command: " + command);
-    Serial3.println("UNKNOWN_COMMAND:" + command);
+  for (char *c = command; *c; c++) {
+    *c = toupper(*c);
+  }
+  currentCommand.assign(command);
+  LOG_DEBUG(MSG_LEGACY_COMMAND, command);
+  halUartPrint(HAL_UART_BLE, "ACK:");
+  halUartPrintln(HAL_UART_BLE, command);
+
+  CommandContext context = {NULL, false, 0};
+  if (!runCommand(command, FORMAT_LEGACY, context)) {
+    LOG_ERROR(MSG_UNKNOWN_COMMAND, command);
+    halUartPrint(HAL_UART_BLE, "UNKNOWN_COMMAND:");
+    halUartPrintln(HAL_UART_BLE, command);
   }
 }
 
-// JSON command processing functions
-bool isValidJson(String jsonString) {
-  StaticJsonDocument<1024> doc;
-  DeserializationError error = deserializeJson(doc, jsonString);
-  return error == DeserializationError::Ok;
+// Only the keys some handler reads are kept; anything else in the payload
+// is skipped by the parser without being stored
+static const JsonDocument &commandFilter() {
+  static JsonDocument filter(&filterArena);
+  static bool built = false;
+  if (!built) {
+    static const char *const keys[] = {"a", "d", "s", "t", "v", "m", "p", "c",
+                                       "action", "direction", "state", "type",
+                                       "component"};
+    for (byte i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+      filter[keys[i]] = true;
+    }
+    // A key that did not fit would be silently dropped from every command
+    if (filter.overflowed()) {
+      LOG_ERROR(MSG_JSON_FILTER_OVERFLOW, FILTER_ARENA_SIZE);
+    }
+    built = true;
+  }
+  return filter;
 }
 
-void processJsonCommand(String jsonString) {
-  Serial.println("🔍 Processing JSON command...");
-  Serial.println("📄 JSON String: " + jsonString);
+// Parse a JSON command once, straight from the receive buffer, and dispatch it
+void processJsonCommand(const char *json) {
+  LOG_DEBUG(MSG_JSON_COMMAND);
 
-  StaticJsonDocument<1024> doc;
-  DeserializationError error = deserializeJson(doc, jsonString);
+#ifdef PROFILE_JSON_PARSE
+  byte *stackTop = repaintStack();
+  unsigned long parseStart = halMicros();
+#endif
+
+  // The previous command's document is gone, so its arena space is free
+  commandArena.reset();
+  JsonDocument doc(&commandArena);
+  DeserializationError error = deserializeJson(
+      doc, json, DeserializationOption::Filter(commandFilter()));
+
+#ifdef PROFILE_JSON_PARSE
+  unsigned long parseUs = halMicros() - parseStart;
+  LOG_INFO(MSG_JSON_PROFILE, parseUs, stackUsedBelow(stackTop),
+           commandArena.used());
+#endif
 
   if (error) {
-    Serial.println("❌ JSON parsing failed: " + String(error.c_str()));
+    LOG_ERROR(MSG_JSON_ERROR, error.c_str());
     return;
   }
 
   // Check if this is a short format command (uses "a" instead of "action")
-  bool isShortFormat = doc.containsKey("a");
-  String action =
-      isShortFormat ? doc["a"].as<String>() : doc["action"].as<String>();
-
-  Serial.println("📋 JSON Action: " + action +
-                 " (Format: " + (isShortFormat ? "SHORT" : "LONG") + ")");
-
-  // Handle short format commands
-  if (isShortFormat) {
-    processShortJsonCommand(doc, action);
-  } else {
-    // Handle original long format commands
-    processLongJsonCommand(doc, action);
+  bool isShortFormat = !doc["a"].isNull();
+  const char *action = isShortFormat ? doc["a"] | "" : doc["action"] | "";
+
+  LOG_DEBUG(MSG_JSON_ACTION, action, isShortFormat ? "SHORT" : "LONG");
+
+  CommandContext context = {&doc, !isShortFormat, 0};
+  if (!runCommand(action, isShortFormat ? FORMAT_SHORT : FORMAT_LONG,
+                  context)) {
+    LOG_ERROR(MSG_UNKNOWN_JSON_COMMAND, isShortFormat ? "short" : "long",
+              action);
   }
 }
 
-// Process short format JSON commands
-void processShortJsonCommand(StaticJsonDocument<1024> &doc, String action) {
-  // Movement commands: {"a":"mv","d":"f"}
-  if (action == "mv") {
-    String direction = doc["d"].as<String>();
-    handleMoveCommand(direction);
-
-    // Component control commands: {"a":"v","s":1}
-  } else if (action == "v") {
-    int state = doc["s"].as<int>();
-    if (state == 1) {
-      startVacuum();
-      Serial.println("Vacuum ON (short)");
-    } else {
-      stopVacuum();
-      Serial.println("Vacuum OFF (short)");
+// Binary search of the sorted PROGMEM table - about five compares for any
+// name, and no RAM spent on the names themselves
+static bool findCommand(const char *name, byte format, CommandName &command) {
+  int low = 0;
+  int high = COMMAND_COUNT - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    int order = strcmp_P(name, commandTable[middle].name);
+    if (order == 0) {
+      memcpy_P(&command, &commandTable[middle], sizeof(command));
+      return command.formats & format;
     }
-    showSystemState();
-  } else if (action == "mp") {  // Mop command
-    int state = doc["s"].as<int>();
-    if (state == 1) {
-      startMop();
-      Serial.println("Mop ON (short)");
+    if (order < 0) {
+      high = middle - 1;
     } else {
-      stopMop();
-      Serial.println("Mop OFF (short)");
+      low = middle + 1;
     }
-    showSystemState();
-  } else if (action == "p") {
-    int state = doc["s"].as<int>();
-    if (state == 1) {
-      startPump();
-      Serial.println("Pump ON (short)");
-    } else {
-      stopPump();
-      Serial.println("Pump OFF (short)");
+  }
+  return false;
+}
+
+// Text replies only go back to the app for legacy commands
+static void reply(const CommandContext &context, const char *text) {
+  if (!context.doc) halUartPrintln(HAL_UART_BLE, text);
+}
+
+// String payload value as a single letter ('\0' if missing or longer)
+static char letterValue(const CommandContext &context, const char *key) {
+  const char *value = (*context.doc)[key] | "";
+  return value[0] && !value[1] ? value[0] : '\0';
+}
+
+// On/off argument: V_ON/V_OFF, {"s":1} or {"state":1}
+static bool stateArg(const CommandContext &context) {
+  if (!context.doc) return context.arg;
+  return (*context.doc)[context.longFormat ? "state" : "s"].as<int>() == 1;
+}
+
+// Direction letter f/b/l/r/s
+static char directionArg(const CommandContext &context) {
+  if (!context.doc) return context.arg;
+  return letterValue(context, context.longFormat ? "direction" : "d");
+}
+
+// Mode letter a/c/m - the long format spells it out
+static char modeArg(const CommandContext &context) {
+  if (!context.doc) return context.arg;
+  if (!context.longFormat) return letterValue(context, "t");
+
+  const char *type = (*context.doc)["type"] | "";
+  if (strcmp(type, "auto") == 0) return 'a';
+  if (strcmp(type, "coverage") == 0) return 'c';
+  if (strcmp(type, "man") == 0) return 'm';
+  return '\0';
+}
+
+static const char *componentName(byte component) {
+  switch (component) {
+    case COMPONENT_VACUUM:
+      return "VACUUM";
+    case COMPONENT_MOP:
+      return "MOP";
+    default:
+      return "PUMP";
+  }
+}
+
+// Multi-component command: optional move, then vacuum/mop/pump. The long
+// format switches off any component it leaves out; the short one only
+// touches the keys it sends
+static void runMulti(const CommandContext &context) {
+  static const char *const keys[] = {"v", "m", "p"};
+  JsonDocument &doc = *context.doc;
+
+  char direction = directionArg(context);
+  if (direction) {
+    handleMoveCommand(direction);
+  }
+
+  for (byte i = 0; i < 3; i++) {
+    if (context.longFormat || !doc[keys[i]].isNull()) {
+      setCleaningMotor(COMPONENT_VACUUM << i, doc[keys[i]].as<int>() == 1);
     }
-    showSystemState();
+  }
+  showSystemState();
+}
 
-    // Mode commands: {"a":"o","t":"a"}
-  } else if (action == "o") {
-    String type = doc["t"].as<String>();
-    if (type == "a") {
-      autoMode = true;
-      Serial.println("✅ Autonomous mode activated (short)");
-    } else if (type == "m") {
-      autoMode = false;
-      stopMotors();
-      Serial.println("✅ Manual mode activated (short)");
+// Look a command up and run its handler; false if it is not a command in
+// this format. Every format ends up in the same handler code
+static bool runCommand(const char *name, byte format,
+                       const CommandContext &context) {
+  CommandName command;
+  if (!findCommand(name, format, command)) return false;
+
+  switch (command.id) {
+    case CMD_HELLO:
+      LOG_INFO(MSG_HELLO);
+      reply(context, "Hello Flutter App!");
+      break;
+
+    case CMD_LINK_TEST:
+      LOG_INFO(MSG_LINK_TEST);
+      reply(context, "TEST_OK");
+      break;
+
+    // Component ids are in COMPONENT_* bit order
+    case CMD_VACUUM:
+    case CMD_MOP:
+    case CMD_PUMP: {
+      byte component = COMPONENT_VACUUM << (command.id - CMD_VACUUM);
+      bool on = stateArg(context);
+      setCleaningMotor(component, on);
+      showSystemState();  // Update LED to show cleaning state
+      if (!context.doc) {
+        halUartPrint(HAL_UART_BLE, componentName(component));
+        halUartPrintln(HAL_UART_BLE, on ? "_ON" : "_OFF");
+      }
+      break;
     }
-    showSystemState();
-
-    // Multi-component commands: {"a":"mu","d":"f","v":1,"m":0,"p":0}
-  } else if (action == "mu") {
-    String direction = doc["d"].as<String>();
-    int v = doc["v"].as<int>();
-    int m = doc["m"].as<int>();
-    int p = doc["p"].as<int>();
-
-    // Handle movement
-    if (direction.length() > 0) {
-      handleMoveCommand(direction);
+
+    case CMD_MODE: {
+      char mode = modeArg(context);
+      if (!setRobotMode(mode)) break;
+      showSystemState();  // Update LED for the new mode
+      reply(context, mode == 'a'   ? "AUTO_MODE_ON"
+                     : mode == 'c' ? "COVERAGE_MODE_ON"
+                                   : "MANUAL_MODE_ON");
+      break;
     }
 
-    // Handle components
-    if (doc.containsKey("v")) {
-      if (v == 1)
+    case CMD_MOVE: {
+      char direction = directionArg(context);
+      if (!handleMoveCommand(direction)) {
+        // Moves refused in auto mode read as unknown to legacy clients
+        if (!context.doc) return false;
+        break;
+      }
+      reply(context, direction == 'f'   ? "MOVING_FORWARD"
+                     : direction == 'b' ? "MOVING_BACKWARD"
+                     : direction == 'l' ? "TURNING_LEFT"
+                     : direction == 'r' ? "TURNING_RIGHT"
+                                        : "STOPPED");
+      break;
+    }
+
+    case CMD_MULTI:
+      runMulti(context);
+      break;
+
+    case CMD_STATUS:
+      sendStatusResponse();
+      break;
+
+    case CMD_MEMORY:
+      printMemoryReport();
+      reply(context, "MEMORY_REPORT");
+      break;
+
+    case CMD_SHOW_STATE:
+      showSystemState();
+      LOG_INFO(MSG_SHOW_STATE);
+      reply(context, "STATUS_DISPLAY");
+      break;
+
+    case CMD_EMERGENCY:
+      emergencyStop();
+      showErrorState();
+      break;
+
+    case CMD_CALIBRATE:
+      reply(context, startTurnCalibration() ? "CALIBRATION_STARTED"
+                                            : "CALIBRATION_FAILED");
+      break;
+
+    case CMD_LED_TEST:
+      // JSON names the component under test: {"a":"t","c":"led"}
+      if (context.doc &&
+          strcmp((*context.doc)[context.longFormat ? "component" : "c"] | "",
+                 "led") != 0) {
+        break;
+      }
+      blinkGreenLED();
+      LOG_INFO(MSG_LED_TEST);
+      reply(context, "LED_BLINK_GREEN");
+      break;
+
+    case CMD_PULSE:
+      pulseBlue();
+      LOG_INFO(MSG_PULSE);
+      reply(context, "PULSE_EFFECT");
+      break;
+  }
+  return true;
+}
+
+// Switch one cleaning motor (a COMPONENT_* bit) on or off
+void setCleaningMotor(byte component, bool on) {
+  switch (component) {
+    case COMPONENT_VACUUM:
+      if (on)
         startVacuum();
       else
         stopVacuum();
-    }
-    if (doc.containsKey("m")) {
-      if (m == 1)
+      break;
+    case COMPONENT_MOP:
+      if (on)
         startMop();
       else
         stopMop();
-    }
-    if (doc.containsKey("p")) {
-      if (p == 1)
+      break;
+    case COMPONENT_PUMP:
+      if (on)
         startPump();
       else
         stopPump();
-    }
-
-    Serial.println("Multi-command executed (short): " + direction +
-                   " v:" + String(v) + " m:" + String(m) + " p:" + String(p));
-    showSystemState();
-
-    // Status commands: {"a":"s"}
-  } else if (action == "s") {
-    sendStatusResponse();
-
-    // Emergency command: {"a":"e"}
-  } else if (action == "e") {
-    stopMotors();
-    stopCleaningMotors();
-    Serial.println("🚨 EMERGENCY STOP (short)");
-    showErrorState();
-
-    // Test command: {"a":"t","c":"led"}
-  } else if (action == "t") {
-    String component = doc["c"].as<String>();
-    if (component == "led") {
-      blinkGreenLED();
-      Serial.println("✅ LED test executed (short)");
-    }
-  } else {
-    Serial.println("❌ Unknown short command: " + action);
+      break;
   }
+  LOG_INFO(MSG_COMPONENT, componentName(component), on ? "ON" : "OFF");
 }
 
-// Process original long format JSON commands
-void processLongJsonCommand(StaticJsonDocument<1024> &doc, String action) {
-  // Movement commands
-  if (action == "move") {
-    String direction = doc["direction"].as<String>();
-    handleMoveCommand(direction);
-
-    // Component control commands
-  } else if (action == "v") {
-    int state = doc["state"].as<int>();
-    if (state == 1) {
-      startVacuum();
-      Serial.println("Vacuum ON");
-    } else {
-      stopVacuum();
-      Serial.println("Vacuum OFF");
-    }
-    showSystemState();
-  } else if (action == "m") {
-    int state = doc["state"].as<int>();
-    if (state == 1) {
-      startMop();
-      Serial.println("Mop ON");
-    } else {
-      stopMop();
-      Serial.println("Mop OFF");
-    }
-    showSystemState();
-  } else if (action == "p") {
-    int state = doc["state"].as<int>();
-    if (state == 1) {
-      startPump();
-      Serial.println("Pump ON");
-    } else {
-      stopPump();
-      Serial.println("Pump OFF");
-    }
-    showSystemState();
-
-    // Mode commands
-  } else if (action == "mode") {
-    String type = doc["type"].as<String>();
-    if (type == "auto") {
+// 'a' = autonomous bounce, 'c' = coverage, 'm' = manual; false if unknown
+bool setRobotMode(char mode) {
+  switch (mode) {
+    case 'a':
+      setNavigationMode(NAV_MODE_BOUNCE);
       autoMode = true;
-      Serial.println("✅ Autonomous mode activated");
-    } else if (type == "man") {
+      LOG_INFO(MSG_AUTO_MODE);
+      return true;
+    case 'c':
+      setNavigationMode(NAV_MODE_COVERAGE);
+      autoMode = true;
+      LOG_INFO(MSG_COVERAGE_MODE);
+      return true;
+    case 'm':
       autoMode = false;
       stopMotors();
-      Serial.println("✅ Manual mode activated");
-    }
-    showSystemState();
-
-    // Multi-component commands
-  } else if (action == "multi") {
-    String direction = doc["direction"].as<String>();
-    int v = doc["v"].as<int>();
-    int m = doc["m"].as<int>();
-    int p = doc["p"].as<int>();
-
-    // Handle movement
-    if (direction.length() > 0) {
-      handleMoveCommand(direction);
-    }
+      LOG_INFO(MSG_MANUAL_MODE);
+      return true;
+  }
+  return false;
+}
 
-    // Handle components
-    if (v == 1)
-      startVacuum();
-    else
-      stopVacuum();
-    if (m == 1)
-      startMop();
-    else
-      stopMop();
-    if (p == 1)
-      startPump();
-    else
-      stopPump();
-
-    Serial.println("Multi-command executed: " + direction + " v:" + String(v) +
-                   " m:" + String(m) + " p:" + String(p));
-    showSystemState();
-
-    // Status commands
-  } else if (action == "status") {
-    sendStatusResponse();
-  } else if (action == "emergency") {
-    stopMotors();
-    stopCleaningMotors();
-    Serial.println("🚨 EMERGENCY STOP");
-    showErrorState();
-  } else if (action == "test") {
-    String component = doc["component"].as<String>();
-    if (component == "led") {
-      blinkGreenLED();
-      Serial.println("✅ LED test executed");
+// Everything off, including a calibration run. The caller shows the error
+// LED once it has replied
+void emergencyStop() {
+  cancelCalibration();
+  stopMotors();
+  stopCleaningMotors();
+  LOG_WARN(MSG_EMERGENCY_STOP);
+}
+
+// Manual drive: f/b/l/r, or s to stop. Only stopping is allowed in auto mode
+// or while calibrating, where it ends the calibration run
+bool handleMoveCommand(char direction) {
+  if (autoMode && direction != 's') {
+    LOG_WARN(MSG_MOVE_IGNORED);
+    return false;
+  }
+  if (isCalibrating()) {
+    if (direction != 's') {
+      LOG_WARN(MSG_MOVE_IGNORED_CALIBRATING);
+      return false;
     }
-  } else {
-    Serial.println("❌ Unknown long command: " + action);
+    cancelCalibration();
   }
-}
 
-void handleMoveCommand(String direction) {
-  if (!autoMode) {  // Only allow manual movement in manual mode
-    if (direction == "f") {
+  switch (direction) {
+    case 'f':
       moveForward();
-      Serial.println("Move command executed: forward");
-    } else if (direction == "b") {
+      LOG_DEBUG(MSG_MOVE, "forward");
+      return true;
+    case 'b':
       moveBackward();
-      Serial.println("Move command executed: backward");
-    } else if (direction == "l") {
+      LOG_DEBUG(MSG_MOVE, "backward");
+      return true;
+    case 'l':
       turnLeft();
-      Serial.println("Move command executed: left");
-    } else if (direction == "r") {
+      LOG_DEBUG(MSG_MOVE, "left");
+      return true;
+    case 'r':
       turnRight();
-      Serial.println("Move command executed: right");
-    } else if (direction == "s") {
+      LOG_DEBUG(MSG_MOVE, "right");
+      return true;
+    case 's':
       stopMotors();
-      Serial.println("Move command executed: stop");
-    }
-  } else {
-    Serial.println("⚠️ Movement ignored - Robot in autonomous mode");
+      LOG_DEBUG(MSG_MOVE, "stop");
+      return true;
   }
+  return false;
 }
 
 void sendStatusResponse() {
-  Serial.println("=== ROBOT STATUS ===");
-  Serial.println("Mode: " + String(autoMode ? "Autonomous" : "Manual"));
-  Serial.println("Vacuum: " + String(vacuumEnabled ? "ON" : "OFF"));
-  Serial.println("Mop: " + String(mopEnabled ? "ON" : "OFF"));
-  Serial.println("Pump: " + String(pumpEnabled ? "ON" : "OFF"));
-  Serial.println("===================");
-}
-
-// Chunking support functions
-bool processChunkedData(byte *data, int length) {
-  if (length < 3) return false;  // Need at least chunk metadata + 1 byte data
-
-  byte chunkNum = data[0];
-  byte totalChunks = data[1];
-
-  Serial.println("Received chunk " + String(chunkNum) + "/" +
-                 String(totalChunks + 1));
-
-  // First chunk - initialize buffer
-  if (chunkNum == 0) {
-    resetChunkBuffer();
-    chunkBuffer.isActive = true;
-    chunkBuffer.totalChunks = totalChunks;
-    chunkBuffer.currentChunk = 0;
-  }
-
-  // Verify chunk sequence
-  if (!chunkBuffer.isActive || chunkNum != chunkBuffer.currentChunk) {
-    Serial.println("❌ Chunk sequence error - resetting");
-    resetChunkBuffer();
-    return false;
-  }
-
-  // Add chunk data to buffer (skip first 2 bytes which are metadata)
-  for (int i = 2; i < length; i++) {
-    chunkBuffer.data += (char)data[i];
-  }
-
-  chunkBuffer.currentChunk++;
-  chunkBuffer.lastChunkTime = millis();
-
-  // Check if we have all chunks
-  if (chunkBuffer.currentChunk > chunkBuffer.totalChunks) {
-    String completeCommand = chunkBuffer.data;
-    Serial.println("✅ Complete chunked command received: " + completeCommand);
-    resetChunkBuffer();
-
-    // Process the complete command
-    processBLECommand(completeCommand);
-    return true;
+  reportMessage(MSG_STATUS_BEGIN);
+  reportMessage(MSG_STATUS_MODE, autoMode ? "Autonomous" : "Manual");
+  reportMessage(MSG_STATUS_COMPONENTS, vacuumEnabled ? "ON" : "OFF",
+                mopEnabled ? "ON" : "OFF", pumpEnabled ? "ON" : "OFF");
+
+  // Distances come from the same filtered snapshot navigation uses
+  static const char *const sensorNames[SENSOR_COUNT] = {
+      "Left", "Right", "Front", "Front-Left", "Front-Right"};
+  const SensorSnapshot &snapshot = getSensorSnapshot();
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    const SensorReading &reading = snapshot.readings[i];
+    if (reading.valid) {
+      reportMessage(MSG_STATUS_DISTANCE, sensorNames[i], reading.distance,
+                    reading.ageMs);
+    } else {
+      reportMessage(MSG_STATUS_NO_DISTANCE, sensorNames[i]);
+    }
   }
 
-  return false;  // Still waiting for more chunks
-}
-
-void resetChunkBuffer() {
-  chunkBuffer.data = "";
-  chunkBuffer.currentChunk = 0;
-  chunkBuffer.totalChunks = 0;
-  chunkBuffer.isActive = false;
-  chunkBuffer.lastChunkTime = 0;
-}
-
-bool isChunkTimeout() {
-  return chunkBuffer.isActive &&
-         (millis() - chunkBuffer.lastChunkTime > CHUNK_TIMEOUT_MS);
+  const Pose &pose = getPose();
+  reportMessage(MSG_STATUS_POSE, pose.x, pose.y, pose.heading);
+  reportMessage(MSG_STATUS_CLEANED, getCleanedCells(), GRID_CELL_CM);
+  reportMessage(
+      MSG_STATUS_RATE, getCleaningRate(),
+      getNavigationMode() == NAV_MODE_COVERAGE ? "coverage" : "bounce");
+  const PowerAllocation &power = getPowerAllocation();
+  reportMessage(MSG_STATUS_POWER, power.totalMa, power.budgetMa,
+                powerStateName(power.state), power.vacuum, power.mop,
+                power.pump);
+  const OutputStats &outputs = getOutputStats();
+  reportMessage(MSG_STATUS_OUTPUTS, outputs.written, outputs.suppressed);
+  reportMessage(MSG_STATUS_LOG, getLogDrops());
+  reportMessage(MSG_STATUS_ARENA, commandArena.peak(), COMMAND_ARENA_SIZE,
+                commandArena.failures());
+  printSchedulerStats();
+  reportMessage(MSG_STATUS_END);
 }
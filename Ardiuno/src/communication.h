@@ -1,21 +1,30 @@
 #ifndef COMMUNICATION_H
 #define COMMUNICATION_H
 
-#include <Arduino.h>
+#include "hal.h"
 #include <ArduinoJson.h>
 
+// Longest text command (a reassembled chunked command included)
+#define MAX_COMMAND_LENGTH 192
+
+// Cleaning motor bits, used by commands and binary frames alike
+#define COMPONENT_VACUUM 0x01
+#define COMPONENT_MOP 0x02
+#define COMPONENT_PUMP 0x04
+
+// Uncomment to print parse time and peak stack/arena use of every JSON command
+// (MSG_JSON_PROFILE)
+// #define PROFILE_JSON_PARSE
+
 // Function declarations for BLE communication
-void processBLECommand(String command);
-void processJsonCommand(String jsonString);
-bool isValidJson(String jsonString);
-void processShortJsonCommand(StaticJsonDocument<1024> &doc, String action);
-void processLongJsonCommand(StaticJsonDocument<1024> &doc, String action);
-void handleMoveCommand(String direction);
+void processBLECommand(char *command);
+void processJsonCommand(const char *json);
 void sendStatusResponse();
 
-// Chunking support function declarations
-bool processChunkedData(byte *data, int length);
-void resetChunkBuffer();
-bool isChunkTimeout();
+// Actions shared by the text and binary command handlers
+void setCleaningMotor(byte component, bool on);
+bool setRobotMode(char mode);
+void emergencyStop();
+bool handleMoveCommand(char direction);
 
 #endif
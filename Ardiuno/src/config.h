@@ -1,7 +1,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
-#include <Arduino.h>
+#include "hal.h"
+#include "fixed_string.h"
 
 // Motor speeds optimized for Arduino Mega (0-255 range)
 extern long motorSpeed;         // Good speed for Arduino Mega
@@ -10,43 +11,68 @@ extern long vacuumSpeed;        // Higher speed for vacuum motor
 extern long mopSpeed;           // Good speed for mop motor
 extern long pumpSpeed;          // Good speed for pump motor
 
+// Motor slew limits in PWM steps per second. Drive accel and decel are kept
+// equal so a timed move covers the same distance as an instant one would
+extern unsigned int driveAccelRate;
+extern unsigned int driveDecelRate;
+extern unsigned int cleaningAccelRate;  // Soft start for vacuum, mop and pump
+extern unsigned int cleaningDecelRate;
+
+// Power budget: full-duty current of each motor (mA). Scaled by the PWM duty
+// cycle this is the current estimate the budget is checked against
+extern unsigned int driveMotorMa;  // Per wheel
+extern unsigned int vacuumMotorMa;
+extern unsigned int mopMotorMa;
+extern unsigned int pumpMotorMa;
+
+// Current ceiling (mA) for everything together, per drive state
+extern unsigned int idleBudgetMa;
+extern unsigned int drivingBudgetMa;
+extern unsigned int turningBudgetMa;
+extern unsigned int reversingBudgetMa;
+
+// Spacing between coverage-mode lanes (a little under the cleaning width)
+extern long laneWidthCm;
+
 // Robot mode state
 extern bool autoMode;  // Start in autonomous mode
-extern String currentCommand;
+extern FixedString<16> currentCommand;  // Last legacy command (cut short)
 
+// Motor driver pin map - fixed by the wiring, so known at compile time and
+// usable as HBridge template arguments (see hbridge.h)
 // Motor A (Left motor) connections - First L298N
-extern int enA;   // PWM pin for motor A speed control
-extern int in1;   // Motor A direction pin 1
-extern int in2;   // Motor A direction pin 2
+constexpr uint8_t enA = 2;   // PWM pin for motor A speed control
+constexpr uint8_t in1 = 22;  // Motor A direction pin 1 (PA0)
+constexpr uint8_t in2 = 23;  // Motor A direction pin 2 (PA1)
 
 // Motor B (Right motor) connections - First L298N
-extern int enB;   // PWM pin for motor B speed control
-extern int in3;   // Motor B direction pin 1
-extern int in4;   // Motor B direction pin 2
+constexpr uint8_t enB = 3;   // PWM pin for motor B speed control
+constexpr uint8_t in3 = 24;  // Motor B direction pin 1 (PA2)
+constexpr uint8_t in4 = 25;  // Motor B direction pin 2 (PA3)
 
 // Second L298N Motor Driver for Vacuum motor only
 // Vacuum Motor (Motor C) connections
-extern int enC;   // PWM pin for vacuum motor speed control
-extern int in5;   // Vacuum motor direction pin 1
-extern int in6;   // Vacuum motor direction pin 2
+constexpr uint8_t enC = 4;   // PWM pin for vacuum motor speed control
+constexpr uint8_t in5 = 26;  // Vacuum motor direction pin 1 (PA4)
+constexpr uint8_t in6 = 27;  // Vacuum motor direction pin 2 (PA5)
 
 // Third L298N Motor Driver for Mop and Pump motors
 // Mop Motor (Motor D) connections
-extern int enD;   // PWM pin for mop motor speed control
-extern int in7;   // Mop motor direction pin 1
-extern int in8;   // Mop motor direction pin 2
+constexpr uint8_t enD = 5;   // PWM pin for mop motor speed control
+constexpr uint8_t in7 = 28;  // Mop motor direction pin 1 (PA6)
+constexpr uint8_t in8 = 29;  // Mop motor direction pin 2 (PA7)
 
 // Pump Motor (Motor E) connections - Third L298N
-extern int enE;    // PWM pin for pump motor speed control
-extern int in9;    // Pump motor direction pin 1
-extern int in10;   // Pump motor direction pin 2
+constexpr uint8_t enE = 9;    // PWM pin for pump motor speed control
+constexpr uint8_t in9 = 30;   // Pump motor direction pin 1 (PC7)
+constexpr uint8_t in10 = 31;  // Pump motor direction pin 2 (PC6)
 
 // Control variables for mop, vacuum and pump
 extern bool mopEnabled;
 extern bool vacuumEnabled;
 extern bool pumpEnabled;
 
-// Sensor pins
+// Sensor pins (echo pins must be on PORTK, A8-A15, for pin-change timing)
 extern int leftTrigPin;
 extern int leftEchoPin;
 extern int rightTrigPin;
@@ -58,6 +84,26 @@ extern int frontLeftEchoPin;
 extern int frontRightTrigPin;
 extern int frontRightEchoPin;
 
+// Ultrasonic mounting angles in degrees (0 = straight ahead, negative = left)
+extern int leftSensorAngle;
+extern int rightSensorAngle;
+extern int frontSensorAngle;
+extern int frontLeftSensorAngle;
+extern int frontRightSensorAngle;
+
+// Ultrasonic ping rates in Hz (0 = sensor disabled)
+extern unsigned int leftPingRate;
+extern unsigned int rightPingRate;
+extern unsigned int frontPingRate;
+extern unsigned int frontLeftPingRate;
+extern unsigned int frontRightPingRate;
+
+// Sensors at least this far apart (degrees) can ping together without crosstalk
+extern int crosstalkMinAngle;
+
+// Fastest believable change in a distance reading (cm/s) - faster is an outlier
+extern long maxDistanceRate;
+
 // LED pin for obstacle detection
 extern int ledPin;
 
@@ -66,16 +112,7 @@ extern int rgbRedPin;    // PWM pin for red
 extern int rgbGreenPin;  // PWM pin for green
 extern int rgbBluePin;   // PWM pin for blue
 
-// Command chunking support for BLE
-struct ChunkBuffer {
-  String data;
-  int currentChunk;
-  int totalChunks;
-  bool isActive;
-  unsigned long lastChunkTime;
-};
-
-extern ChunkBuffer chunkBuffer;
+// A chunked BLE command is dropped if no chunk arrives for this long
 extern const unsigned long CHUNK_TIMEOUT_MS;
 
 #endif
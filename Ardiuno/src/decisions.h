@@ -0,0 +1,128 @@
+#ifndef DECISIONS_H
+#define DECISIONS_H
+
+#include "hal.h"
+
+// Obstacle mask bits - one per sensor direction, left to right
+#define MASK_LEFT 0x01
+#define MASK_FRONT_LEFT 0x02
+#define MASK_FRONT 0x04
+#define MASK_FRONT_RIGHT 0x08
+#define MASK_RIGHT 0x10
+#define MASK_COUNT 32
+
+// Manoeuvres the decision tables can pick
+enum Manoeuvre {
+  MANOEUVRE_FORWARD,               // Path clear, keep driving
+  MANOEUVRE_NUDGE_LEFT,            // Short left turn off a side collision
+  MANOEUVRE_NUDGE_RIGHT,           // Short right turn off a side collision
+  MANOEUVRE_BACK_UP,               // Both sides touching, reverse
+  MANOEUVRE_TURN_LEFT,             // Front and front-right blocked
+  MANOEUVRE_TURN_RIGHT,            // Front and front-left blocked
+  MANOEUVRE_U_TURN,                // Dead end
+  MANOEUVRE_CLEAR_LEFT,            // Turn left until front-right clears
+  MANOEUVRE_CLEAR_RIGHT,           // Turn right until front-left clears
+  MANOEUVRE_BACK_UP_AND_PAUSE,     // Both front corners blocked
+  MANOEUVRE_TOWARD_CLEARER,        // Tie-break: short turn to the longer side
+  MANOEUVRE_AVOID_LEFT,            // Avoidance: long left turn
+  MANOEUVRE_AVOID_RIGHT,           // Avoidance: long right turn
+  MANOEUVRE_AVOID_TOWARD_CLEARER,  // Tie-break: long turn, turn around if equal
+  MANOEUVRE_BACK_UP_AND_TURN       // Avoidance: everything blocked
+};
+
+// Expand a table row function over all 32 masks
+#define MASK_ROWS_8(f, base)                                             \
+  f(base), f(base + 1), f(base + 2), f(base + 3), f(base + 4), f(base + 5), \
+      f(base + 6), f(base + 7)
+#define MASK_ROWS(f) \
+  MASK_ROWS_8(f, 0), MASK_ROWS_8(f, 8), MASK_ROWS_8(f, 16), MASK_ROWS_8(f, 24)
+
+// Driving decision. Front bits are obstacles (< obstacleThreshold), side bits
+// are collisions (touching distance); sides only matter when the front is clear
+constexpr byte driveManoeuvre(byte mask) {
+  return !(mask & (MASK_FRONT | MASK_FRONT_LEFT | MASK_FRONT_RIGHT))
+             ? ((mask & MASK_LEFT) && (mask & MASK_RIGHT) ? MANOEUVRE_BACK_UP
+                : (mask & MASK_LEFT)  ? MANOEUVRE_NUDGE_RIGHT
+                : (mask & MASK_RIGHT) ? MANOEUVRE_NUDGE_LEFT
+                                      : MANOEUVRE_FORWARD)
+         : (mask & MASK_FRONT)
+             ? ((mask & MASK_FRONT_LEFT) && (mask & MASK_FRONT_RIGHT)
+                    ? MANOEUVRE_U_TURN
+                : (mask & MASK_FRONT_LEFT)  ? MANOEUVRE_TURN_RIGHT
+                : (mask & MASK_FRONT_RIGHT) ? MANOEUVRE_TURN_LEFT
+                                            : MANOEUVRE_TOWARD_CLEARER)
+         : (mask & MASK_FRONT_LEFT) && (mask & MASK_FRONT_RIGHT)
+             ? MANOEUVRE_BACK_UP_AND_PAUSE
+         : (mask & MASK_FRONT_LEFT) ? MANOEUVRE_CLEAR_RIGHT
+                                    : MANOEUVRE_CLEAR_LEFT;
+}
+
+// Avoidance decision after settling. Every bit is an obstacle (< threshold);
+// prefer a side whose corner and flank are both clear
+constexpr byte avoidManoeuvre(byte mask) {
+  return !(mask & (MASK_LEFT | MASK_FRONT_LEFT))     ? MANOEUVRE_AVOID_LEFT
+         : !(mask & (MASK_RIGHT | MASK_FRONT_RIGHT)) ? MANOEUVRE_AVOID_RIGHT
+         : !(mask & (MASK_FRONT_LEFT | MASK_FRONT_RIGHT))
+             ? MANOEUVRE_AVOID_TOWARD_CLEARER
+         : !(mask & MASK_FRONT_LEFT)  ? MANOEUVRE_AVOID_LEFT
+         : !(mask & MASK_FRONT_RIGHT) ? MANOEUVRE_AVOID_RIGHT
+                                      : MANOEUVRE_BACK_UP_AND_TURN;
+}
+
+// Spot checks of the tables
+static_assert(driveManoeuvre(0) == MANOEUVRE_FORWARD, "clear path drives on");
+static_assert(driveManoeuvre(MASK_LEFT | MASK_RIGHT) == MANOEUVRE_BACK_UP,
+              "both sides touching backs up");
+static_assert(driveManoeuvre(MASK_FRONT | MASK_FRONT_LEFT | MASK_FRONT_RIGHT |
+                             MASK_LEFT) == MANOEUVRE_U_TURN,
+              "dead end turns around regardless of sides");
+static_assert(driveManoeuvre(MASK_FRONT) == MANOEUVRE_TOWARD_CLEARER,
+              "front-only block needs the distance tie-break");
+static_assert(avoidManoeuvre(MASK_COUNT - 1) == MANOEUVRE_BACK_UP_AND_TURN,
+              "fully boxed in backs up and turns");
+static_assert(avoidManoeuvre(MASK_LEFT | MASK_RIGHT) ==
+                  MANOEUVRE_AVOID_TOWARD_CLEARER,
+              "both corners clear needs the distance tie-break");
+
+// Every row of both tables against the old if/else cascade, one sensor flag
+// per argument
+constexpr byte driveReference(bool left, bool frontLeft, bool front,
+                              bool frontRight, bool right) {
+  return !front && !frontLeft && !frontRight
+             ? (left && !right   ? MANOEUVRE_NUDGE_RIGHT
+                : right && !left ? MANOEUVRE_NUDGE_LEFT
+                : left && right  ? MANOEUVRE_BACK_UP
+                                 : MANOEUVRE_FORWARD)
+         : front ? (frontLeft && !frontRight   ? MANOEUVRE_TURN_RIGHT
+                    : frontRight && !frontLeft ? MANOEUVRE_TURN_LEFT
+                    : frontLeft && frontRight  ? MANOEUVRE_U_TURN
+                                               : MANOEUVRE_TOWARD_CLEARER)
+         : frontLeft && !frontRight ? MANOEUVRE_CLEAR_RIGHT
+         : frontRight && !frontLeft ? MANOEUVRE_CLEAR_LEFT
+                                    : MANOEUVRE_BACK_UP_AND_PAUSE;
+}
+
+constexpr byte avoidReference(bool left, bool frontLeft, bool frontRight,
+                              bool right) {
+  return !left && !frontLeft           ? MANOEUVRE_AVOID_LEFT
+         : !right && !frontRight     ? MANOEUVRE_AVOID_RIGHT
+         : !frontLeft && !frontRight ? MANOEUVRE_AVOID_TOWARD_CLEARER
+         : !frontLeft                ? MANOEUVRE_AVOID_LEFT
+         : !frontRight               ? MANOEUVRE_AVOID_RIGHT
+                                     : MANOEUVRE_BACK_UP_AND_TURN;
+}
+
+constexpr bool rowsMatch(byte mask) {
+  return mask == MASK_COUNT ||
+         (driveManoeuvre(mask) ==
+              driveReference(mask & MASK_LEFT, mask & MASK_FRONT_LEFT,
+                             mask & MASK_FRONT, mask & MASK_FRONT_RIGHT,
+                             mask & MASK_RIGHT) &&
+          avoidManoeuvre(mask) ==
+              avoidReference(mask & MASK_LEFT, mask & MASK_FRONT_LEFT,
+                             mask & MASK_FRONT_RIGHT, mask & MASK_RIGHT) &&
+          rowsMatch(mask + 1));
+}
+static_assert(rowsMatch(0), "decision tables match the reference cascade");
+
+#endif
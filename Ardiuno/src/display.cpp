@@ -1,44 +1,46 @@
 #include "display.h"
-#include <Wire.h>
-
-// LCD Display object
-LiquidCrystal_I2C lcd(0x27, 16, 2);
 
 void initializeLCD() {
-  // Initialize I2C communication for LCD (Arduino Mega: SDA=20, SCL=21)
-  Wire.begin();
+  // Initialize the I2C LCD (see hal_avr.cpp for the wiring)
+  halLcdBegin();
+  halLcdClear();
+  halLcdSetCursor(0, 0);
+  halLcdPrint("Arduino Mega");
+  halLcdSetCursor(0, 1);
+  halLcdPrint("Robot Starting..");
+  halDelay(2000);
+}
 
-  // Initialize I2C LCD
-  lcd.init();
-  lcd.backlight();
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print("Arduino Mega");
-  lcd.setCursor(0, 1);
-  lcd.print("Robot Starting..");
-  delay(2000);
+// Print one filtered distance, or "--" when the sensor has no valid reading
+static void printDistance(const SensorReading &reading) {
+  if (reading.valid) {
+    halLcdPrint(reading.distance);
+  } else {
+    halLcdPrint("--");
+  }
 }
 
 // LCD Display function
-void updateLCD(String status, long leftDist, long rightDist, long frontDist,
-               long frontLeftDist, long frontRightDist) {
-  lcd.clear();
+void updateLCD(const char *status, const SensorSnapshot &snapshot) {
+  halLcdClear();
 
   // First line: Left, Front-Left, Front distances
-  lcd.setCursor(0, 0);
-  lcd.print("L:");
-  lcd.print(leftDist);
-  lcd.print(",FL:");
-  lcd.print(frontLeftDist);
-  lcd.print(",F:");
-  lcd.print(frontDist);
+  halLcdSetCursor(0, 0);
+  halLcdPrint("L:");
+  printDistance(snapshot.readings[SENSOR_LEFT]);
+  halLcdPrint(",FL:");
+  printDistance(snapshot.readings[SENSOR_FRONT_LEFT]);
+  halLcdPrint(",F:");
+  printDistance(snapshot.readings[SENSOR_FRONT]);
 
   // Second line: Front-Right, Right distances and status
-  lcd.setCursor(0, 1);
-  lcd.print("FR:");
-  lcd.print(frontRightDist);
-  lcd.print(",R:");
-  lcd.print(rightDist);
-  lcd.print(" ");
-  lcd.print(status.substring(0, 3));  // Show first 3 chars of status
+  halLcdSetCursor(0, 1);
+  halLcdPrint("FR:");
+  printDistance(snapshot.readings[SENSOR_FRONT_RIGHT]);
+  halLcdPrint(",R:");
+  printDistance(snapshot.readings[SENSOR_RIGHT]);
+  halLcdPrint(" ");
+  for (byte i = 0; i < 3 && status[i]; i++) {
+    halLcdWrite(status[i]);  // Show first 3 chars of status
+  }
 }
@@ -1,15 +1,11 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
-#include <Arduino.h>
-#include <LiquidCrystal_I2C.h>
-
-// LCD Display object (external declaration)
-extern LiquidCrystal_I2C lcd;
+#include "hal.h"
+#include "sensors.h"
 
 // Function declarations for display operations
 void initializeLCD();
-void updateLCD(String status, long leftDist, long rightDist, long frontDist,
-               long frontLeftDist, long frontRightDist);
+void updateLCD(const char *status, const SensorSnapshot &snapshot);
 
 #endif
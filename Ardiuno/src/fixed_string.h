@@ -0,0 +1,62 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include "hal.h"
+
+// Text with its storage inline and a capacity fixed at compile time - the
+// heap-free stand-in for String. Anything past the capacity is cut off
+template <size_t CAPACITY>
+class FixedString {
+ public:
+  FixedString() {
+    clear();
+  }
+
+  void clear() {
+    length_ = 0;
+    text_[0] = '\0';
+  }
+
+  // Replace the contents; returns false if the text had to be cut short
+  bool assign(const char *text) {
+    clear();
+    return append(text);
+  }
+
+  bool append(const char *text) {
+    while (*text) {
+      if (!append(*text++)) return false;
+    }
+    return true;
+  }
+
+  bool append(char c) {
+    if (length_ >= CAPACITY) return false;
+    text_[length_++] = c;
+    text_[length_] = '\0';
+    return true;
+  }
+
+  FixedString &operator=(const char *text) {
+    assign(text);
+    return *this;
+  }
+
+  const char *c_str() const {
+    return text_;
+  }
+
+  size_t length() const {
+    return length_;
+  }
+
+  static constexpr size_t capacity() {
+    return CAPACITY;
+  }
+
+ private:
+  char text_[CAPACITY + 1];
+  size_t length_;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef HAL_H
+#define HAL_H
+
+// Hardware abstraction layer: everything the firmware touches on the board
+// goes through these functions. hal_avr.cpp maps them onto the Arduino core
+// for the Mega; hal_native.cpp emulates them on the host ([env:native]) with
+// a clock that only moves when told to, so runs are repeatable
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include "hal_native.h"
+#endif
+
+// Clock. On the host halDelay() just moves the clock forward
+unsigned long halMillis();
+unsigned long halMicros();
+void halDelay(unsigned long ms);
+void halDelayMicroseconds(unsigned int us);
+
+// GPIO and PWM, by Arduino pin number
+void halPinMode(byte pin, byte mode);
+void halDigitalWrite(byte pin, byte level);
+byte halDigitalRead(byte pin);
+void halAnalogWrite(byte pin, byte duty);
+
+// Whole-port access for pins that must change together (see hbridge.h)
+enum HalPort { HAL_PORT_A, HAL_PORT_C };
+void halWritePort(HalPort port, byte mask, byte bits);  // Atomic
+void halSetPortOutputs(HalPort port, byte mask);
+
+// Interrupts off/on around data shared with the echo handler
+void halInterruptsOff();
+void halInterruptsOn();
+
+// Echo timing. Echo pins share one pin-change port (A8-A15 on the Mega); the
+// handler gets that port's levels and micros() on every edge, from interrupt
+// context
+typedef void (*EchoHandler)(byte levels, unsigned long now);
+byte halEchoMask(byte pin);  // Bit of the pin in the echo levels, 0 = unusable
+byte halEchoLevels();
+void halBeginEchoCapture(byte mask, EchoHandler handler);
+
+// UARTs
+enum HalUart {
+  HAL_UART_DEBUG,  // USB serial: log records
+  HAL_UART_BLE     // HM-10 module
+};
+void halUartBegin(HalUart uart, unsigned long baud);
+int halUartAvailable(HalUart uart);
+int halUartRead(HalUart uart);  // -1 if nothing is waiting
+int halUartAvailableForWrite(HalUart uart);
+void halUartWrite(HalUart uart, const byte *data, size_t length);
+void halUartPrint(HalUart uart, const char *text);
+void halUartPrint(HalUart uart, unsigned int value);
+void halUartPrintln(HalUart uart, const char *text = "");
+void halUartPrintln(HalUart uart, unsigned int value);
+
+// 16x2 character LCD
+void halLcdBegin();
+void halLcdClear();
+void halLcdSetCursor(byte column, byte row);
+void halLcdPrint(const char *text);
+void halLcdPrint(long value);
+void halLcdWrite(char c);
+
+// EEPROM. Writes skip bytes that already hold the value
+void halEepromRead(int address, void *data, size_t length);
+void halEepromWrite(int address, const void *data, size_t length);
+
+// RAM layout for the memory report (see memory.cpp)
+struct HalRamLayout {
+  byte *dataStart;
+  byte *dataEnd;
+  byte *bssStart;
+  byte *bssEnd;
+  byte *heapStart;
+  byte *heapTop;  // Current end of the heap (heapStart if nothing allocated)
+  byte *ramEnd;   // Last byte of RAM
+};
+HalRamLayout halRamLayout();
+byte *halStackPointer();
+void halHeapFreeList(unsigned int &freeBytes, byte &blocks,
+                     unsigned int &largest);
+
+#ifndef ARDUINO
+// Host backend only: drive the inputs and inspect the outputs
+void halSetMicros(unsigned long us);
+void halAdvanceMicros(unsigned long us);
+void halSetPinInput(byte pin, byte level);  // Echo pins fire the handler
+byte halPinOutput(byte pin);
+unsigned int halPinRises(byte pin);  // LOW to HIGH writes so far
+byte halPwmOutput(byte pin);
+byte halPortOutput(HalPort port);
+void halUartInject(HalUart uart, const byte *data, size_t length);
+size_t halUartTake(HalUart uart, byte *data, size_t maxLength);
+const char *halLcdLine(byte row);
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+#ifdef ARDUINO
+#include "hal.h"
+#include <EEPROM.h>
+#include <LiquidCrystal_I2C.h>
+#include <Wire.h>
+#include <util/atomic.h>
+
+// Mega backend: thin forwards to the Arduino core, registers where the core
+// is too slow or has no equivalent
+
+unsigned long halMillis() {
+  return millis();
+}
+
+unsigned long halMicros() {
+  return micros();
+}
+
+void halDelay(unsigned long ms) {
+  delay(ms);
+}
+
+void halDelayMicroseconds(unsigned int us) {
+  delayMicroseconds(us);
+}
+
+void halPinMode(byte pin, byte mode) {
+  pinMode(pin, mode);
+}
+
+void halDigitalWrite(byte pin, byte level) {
+  digitalWrite(pin, level);
+}
+
+byte halDigitalRead(byte pin) {
+  return digitalRead(pin);
+}
+
+void halAnalogWrite(byte pin, byte duty) {
+  analogWrite(pin, duty);
+}
+
+static volatile uint8_t &portRegister(HalPort port) {
+  return port == HAL_PORT_A ? PORTA : PORTC;
+}
+
+// Read-modify-write with interrupts held off so nothing lands in between
+void halWritePort(HalPort port, byte mask, byte bits) {
+  volatile uint8_t &reg = portRegister(port);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    reg = (reg & ~mask) | bits;
+  }
+}
+
+void halSetPortOutputs(HalPort port, byte mask) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    (port == HAL_PORT_A ? DDRA : DDRC) |= mask;
+  }
+}
+
+void halInterruptsOff() {
+  noInterrupts();
+}
+
+void halInterruptsOn() {
+  interrupts();
+}
+
+// Echo pins are on PORTK (A8-A15), so one PCINT2 vector sees every edge
+static EchoHandler echoHandler = NULL;
+
+ISR(PCINT2_vect) {
+  unsigned long now = micros();
+  if (echoHandler) echoHandler(PINK, now);
+}
+
+byte halEchoMask(byte pin) {
+  return digitalPinToPCICRbit(pin) == PCIE2 ? digitalPinToBitMask(pin) : 0;
+}
+
+byte halEchoLevels() {
+  return PINK;
+}
+
+void halBeginEchoCapture(byte mask, EchoHandler handler) {
+  echoHandler = handler;
+  PCMSK2 |= mask;  // PCINT16-23 are PK0-PK7, the same bits as PINK
+  PCICR |= bit(PCIE2);
+}
+
+static HardwareSerial &uartPort(HalUart uart) {
+  return uart == HAL_UART_BLE ? Serial3 : Serial;
+}
+
+void halUartBegin(HalUart uart, unsigned long baud) {
+  uartPort(uart).begin(baud);
+}
+
+int halUartAvailable(HalUart uart) {
+  return uartPort(uart).available();
+}
+
+int halUartRead(HalUart uart) {
+  return uartPort(uart).read();
+}
+
+int halUartAvailableForWrite(HalUart uart) {
+  return uartPort(uart).availableForWrite();
+}
+
+void halUartWrite(HalUart uart, const byte *data, size_t length) {
+  uartPort(uart).write(data, length);
+}
+
+void halUartPrint(HalUart uart, const char *text) {
+  uartPort(uart).print(text);
+}
+
+void halUartPrint(HalUart uart, unsigned int value) {
+  uartPort(uart).print(value);
+}
+
+void halUartPrintln(HalUart uart, const char *text) {
+  uartPort(uart).println(text);
+}
+
+void halUartPrintln(HalUart uart, unsigned int value) {
+  uartPort(uart).println(value);
+}
+
+// I2C backpack at 0x27 (SDA=20, SCL=21 on the Mega)
+static LiquidCrystal_I2C lcd(0x27, 16, 2);
+
+void halLcdBegin() {
+  Wire.begin();
+  lcd.init();
+  lcd.backlight();
+}
+
+void halLcdClear() {
+  lcd.clear();
+}
+
+void halLcdSetCursor(byte column, byte row) {
+  lcd.setCursor(column, row);
+}
+
+void halLcdPrint(const char *text) {
+  lcd.print(text);
+}
+
+void halLcdPrint(long value) {
+  lcd.print(value);
+}
+
+void halLcdWrite(char c) {
+  lcd.write(c);
+}
+
+void halEepromRead(int address, void *data, size_t length) {
+  byte *bytes = (byte *)data;
+  for (size_t i = 0; i < length; i++) {
+    bytes[i] = EEPROM.read(address + i);
+  }
+}
+
+void halEepromWrite(int address, const void *data, size_t length) {
+  const byte *bytes = (const byte *)data;
+  for (size_t i = 0; i < length; i++) {
+    EEPROM.update(address + i, bytes[i]);
+  }
+}
+
+// Linker symbols for the RAM layout. The heap ones are weak: they live in
+// avr-libc's malloc.o, which is only linked in if something calls malloc
+extern char __data_start;
+extern char __data_end;
+extern char __bss_start;
+extern char __bss_end;
+extern char __heap_start;
+extern "C" {
+struct FreeBlock {
+  size_t size;
+  FreeBlock *next;
+};
+extern char *__brkval __attribute__((weak));
+extern FreeBlock *__flp __attribute__((weak));
+}
+
+HalRamLayout halRamLayout() {
+  HalRamLayout layout;
+  layout.dataStart = (byte *)&__data_start;
+  layout.dataEnd = (byte *)&__data_end;
+  layout.bssStart = (byte *)&__bss_start;
+  layout.bssEnd = (byte *)&__bss_end;
+  layout.heapStart = (byte *)&__heap_start;
+  layout.heapTop = &__brkval && __brkval ? (byte *)__brkval : layout.heapStart;
+  layout.ramEnd = (byte *)RAMEND;
+  return layout;
+}
+
+byte *halStackPointer() {
+  return (byte *)SP;
+}
+
+void halHeapFreeList(unsigned int &freeBytes, byte &blocks,
+                     unsigned int &largest) {
+  freeBytes = 0;
+  blocks = 0;
+  largest = 0;
+  if (!&__flp) return;
+  for (FreeBlock *block = __flp; block; block = block->next) {
+    freeBytes += block->size;
+    blocks++;
+    if (block->size > largest) largest = block->size;
+  }
+}
+#endif
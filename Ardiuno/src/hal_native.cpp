@@ -0,0 +1,314 @@
+#ifndef ARDUINO
+#include "hal.h"
+#include <stdio.h>
+
+// Host backend: the board is a handful of arrays. Nothing moves unless the
+// caller moves it - the clock advances only through halSetMicros(),
+// halAdvanceMicros() and the delays, inputs change only through the hooks
+// at the end of hal.h - so every run of the same inputs is identical
+
+#define HOST_PIN_COUNT 70      // Mega digital + analog pins
+#define HOST_ECHO_FIRST_PIN A8  // PORTK, as on the Mega
+#define HOST_UART_BUFFER 1024
+#define HOST_UART_TX_ROOM 63   // What the Mega core's TX buffer reports
+#define HOST_EEPROM_SIZE 4096
+#define HOST_RAM_SIZE 8192
+
+static unsigned long long clockMicros = 0;
+
+unsigned long halMillis() {
+  return clockMicros / 1000;
+}
+
+unsigned long halMicros() {
+  return clockMicros;
+}
+
+void halDelay(unsigned long ms) {
+  clockMicros += ms * 1000ULL;
+}
+
+void halDelayMicroseconds(unsigned int us) {
+  clockMicros += us;
+}
+
+static byte pinModes[HOST_PIN_COUNT];
+static byte pinOutputs[HOST_PIN_COUNT];
+static unsigned int pinRises[HOST_PIN_COUNT];  // Pulses too short to see
+static byte pinInputs[HOST_PIN_COUNT];
+static byte pwmOutputs[HOST_PIN_COUNT];
+static byte portOutputs[2];
+
+void halPinMode(byte pin, byte mode) {
+  if (pin < HOST_PIN_COUNT) pinModes[pin] = mode;
+}
+
+void halDigitalWrite(byte pin, byte level) {
+  if (pin >= HOST_PIN_COUNT) return;
+  if (level && !pinOutputs[pin]) pinRises[pin]++;
+  pinOutputs[pin] = level;
+}
+
+byte halDigitalRead(byte pin) {
+  return pin < HOST_PIN_COUNT ? pinInputs[pin] : LOW;
+}
+
+void halAnalogWrite(byte pin, byte duty) {
+  if (pin < HOST_PIN_COUNT) pwmOutputs[pin] = duty;
+}
+
+void halWritePort(HalPort port, byte mask, byte bits) {
+  portOutputs[port] = (portOutputs[port] & ~mask) | bits;
+}
+
+void halSetPortOutputs(HalPort port, byte mask) {
+  (void)port;
+  (void)mask;
+}
+
+// Nothing runs concurrently on the host: echo edges are delivered inline by
+// halSetPinInput()
+void halInterruptsOff() {}
+
+void halInterruptsOn() {}
+
+static EchoHandler echoHandler = NULL;
+static byte echoCaptureMask = 0;
+static byte echoLevels = 0;
+
+byte halEchoMask(byte pin) {
+  if (pin < HOST_ECHO_FIRST_PIN || pin >= HOST_ECHO_FIRST_PIN + 8) return 0;
+  return _BV(pin - HOST_ECHO_FIRST_PIN);
+}
+
+byte halEchoLevels() {
+  return echoLevels;
+}
+
+void halBeginEchoCapture(byte mask, EchoHandler handler) {
+  echoHandler = handler;
+  echoCaptureMask |= mask;
+}
+
+struct HostUart {
+  byte rx[HOST_UART_BUFFER];
+  size_t rxHead;  // Next byte read
+  size_t rxTail;  // Next byte injected
+  byte tx[HOST_UART_BUFFER];
+  size_t txLength;
+};
+
+static HostUart uarts[2];
+
+void halUartBegin(HalUart uart, unsigned long baud) {
+  (void)baud;
+  uarts[uart].rxHead = uarts[uart].rxTail = 0;
+  uarts[uart].txLength = 0;
+}
+
+int halUartAvailable(HalUart uart) {
+  return uarts[uart].rxTail - uarts[uart].rxHead;
+}
+
+int halUartRead(HalUart uart) {
+  HostUart &port = uarts[uart];
+  return port.rxHead < port.rxTail ? port.rx[port.rxHead++] : -1;
+}
+
+int halUartAvailableForWrite(HalUart uart) {
+  return min(HOST_UART_BUFFER - uarts[uart].txLength,
+             (size_t)HOST_UART_TX_ROOM);
+}
+
+// Output past a full capture buffer is dropped - collect it with
+// halUartTake() often enough
+void halUartWrite(HalUart uart, const byte *data, size_t length) {
+  HostUart &port = uarts[uart];
+  length = min(length, HOST_UART_BUFFER - port.txLength);
+  memcpy(port.tx + port.txLength, data, length);
+  port.txLength += length;
+}
+
+void halUartPrint(HalUart uart, const char *text) {
+  halUartWrite(uart, (const byte *)text, strlen(text));
+}
+
+void halUartPrint(HalUart uart, unsigned int value) {
+  char text[12];
+  snprintf(text, sizeof(text), "%u", value);
+  halUartPrint(uart, text);
+}
+
+void halUartPrintln(HalUart uart, const char *text) {
+  halUartPrint(uart, text);
+  halUartPrint(uart, "\r\n");
+}
+
+void halUartPrintln(HalUart uart, unsigned int value) {
+  halUartPrint(uart, value);
+  halUartPrint(uart, "\r\n");
+}
+
+// 16x2 character buffer
+static char lcdLines[2][17];
+static byte lcdColumn = 0;
+static byte lcdRow = 0;
+
+void halLcdBegin() {
+  halLcdClear();
+}
+
+void halLcdClear() {
+  for (byte row = 0; row < 2; row++) {
+    memset(lcdLines[row], ' ', 16);
+    lcdLines[row][16] = '\0';
+  }
+  lcdColumn = lcdRow = 0;
+}
+
+void halLcdSetCursor(byte column, byte row) {
+  lcdColumn = column;
+  lcdRow = row;
+}
+
+void halLcdWrite(char c) {
+  if (lcdRow < 2 && lcdColumn < 16) lcdLines[lcdRow][lcdColumn] = c;
+  lcdColumn++;
+}
+
+void halLcdPrint(const char *text) {
+  while (*text) halLcdWrite(*text++);
+}
+
+void halLcdPrint(long value) {
+  char text[12];
+  snprintf(text, sizeof(text), "%ld", value);
+  halLcdPrint(text);
+}
+
+// Starts erased, like a new board
+static byte eeprom[HOST_EEPROM_SIZE];
+static bool eepromErased = false;
+
+static byte *eepromBytes() {
+  if (!eepromErased) {
+    memset(eeprom, 0xFF, sizeof(eeprom));
+    eepromErased = true;
+  }
+  return eeprom;
+}
+
+void halEepromRead(int address, void *data, size_t length) {
+  memcpy(data, eepromBytes() + address, length);
+}
+
+void halEepromWrite(int address, const void *data, size_t length) {
+  memcpy(eepromBytes() + address, data, length);
+}
+
+// A stand-in Mega RAM map, so the stack paint and memory report have
+// somewhere to work. The figures say nothing about the host build
+static byte ram[HOST_RAM_SIZE];
+
+HalRamLayout halRamLayout() {
+  HalRamLayout layout;
+  layout.dataStart = ram;
+  layout.dataEnd = layout.bssStart = ram + 512;
+  layout.bssEnd = layout.heapStart = layout.heapTop = ram + 4096;
+  layout.ramEnd = ram + HOST_RAM_SIZE - 1;
+  return layout;
+}
+
+byte *halStackPointer() {
+  return ram + HOST_RAM_SIZE - 512;
+}
+
+void halHeapFreeList(unsigned int &freeBytes, byte &blocks,
+                     unsigned int &largest) {
+  freeBytes = 0;
+  blocks = 0;
+  largest = 0;
+}
+
+void halSetMicros(unsigned long us) {
+  clockMicros = us;
+}
+
+void halAdvanceMicros(unsigned long us) {
+  clockMicros += us;
+}
+
+// An echo pin edge reaches the echo handler straight away, the way the
+// pin-change interrupt would
+void halSetPinInput(byte pin, byte level) {
+  if (pin >= HOST_PIN_COUNT) return;
+  pinInputs[pin] = level;
+
+  byte mask = halEchoMask(pin);
+  if (!mask) return;
+  byte levels = level ? echoLevels | mask : echoLevels & ~mask;
+  bool changed = levels != echoLevels;
+  echoLevels = levels;
+  if (changed && (echoCaptureMask & mask) && echoHandler) {
+    echoHandler(echoLevels, halMicros());
+  }
+}
+
+byte halPinOutput(byte pin) {
+  return pin < HOST_PIN_COUNT ? pinOutputs[pin] : LOW;
+}
+
+unsigned int halPinRises(byte pin) {
+  return pin < HOST_PIN_COUNT ? pinRises[pin] : 0;
+}
+
+byte halPwmOutput(byte pin) {
+  return pin < HOST_PIN_COUNT ? pwmOutputs[pin] : 0;
+}
+
+byte halPortOutput(HalPort port) {
+  return portOutputs[port];
+}
+
+void halUartInject(HalUart uart, const byte *data, size_t length) {
+  HostUart &port = uarts[uart];
+  if (port.rxHead == port.rxTail) port.rxHead = port.rxTail = 0;
+  length = min(length, HOST_UART_BUFFER - port.rxTail);
+  memcpy(port.rx + port.rxTail, data, length);
+  port.rxTail += length;
+}
+
+size_t halUartTake(HalUart uart, byte *data, size_t maxLength) {
+  HostUart &port = uarts[uart];
+  size_t length = min(port.txLength, maxLength);
+  memcpy(data, port.tx, length);
+  memmove(port.tx, port.tx + length, port.txLength - length);
+  port.txLength -= length;
+  return length;
+}
+
+const char *halLcdLine(byte row) {
+  return row < 2 ? lcdLines[row] : "";
+}
+
+#ifndef PIO_UNIT_TESTING
+void setup();
+void loop();
+
+// `pio run -e native` builds the whole sketch as a host program: one loop()
+// pass per simulated millisecond, log records to stdout (pipe them into
+// tools/decode_log.py -)
+int main() {
+  setup();
+  for (;;) {
+    loop();
+    halAdvanceMicros(1000);
+
+    byte output[HOST_UART_BUFFER];
+    size_t length = halUartTake(HAL_UART_DEBUG, output, sizeof(output));
+    fwrite(output, 1, length, stdout);
+    fflush(stdout);
+  }
+}
+#endif
+#endif
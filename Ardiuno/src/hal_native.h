@@ -0,0 +1,57 @@
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+// The parts of the Arduino core the firmware uses as plain language (types,
+// PROGMEM access, small helpers), for host builds where there is no core.
+// Only included through hal.h
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+// Mega analog pin numbers (the echo pins)
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+// One address space on the host, so flash reads are ordinary reads
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+
+#define bit(b) (1UL << (b))
+#define _BV(b) (1 << (b))
+#define constrain(x, low, high) \
+  ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+// Like the core's macros, these take mixed argument types
+template <class A, class B>
+auto min(A a, B b) -> decltype(a < b ? a : b) {
+  return a < b ? a : b;
+}
+
+template <class A, class B>
+auto max(A a, B b) -> decltype(a > b ? a : b) {
+  return a > b ? a : b;
+}
+
+#endif
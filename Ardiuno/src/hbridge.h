@@ -0,0 +1,114 @@
+#ifndef HBRIDGE_H
+#define HBRIDGE_H
+
+#include "hal.h"
+#include "outputs.h"
+
+// Direction of one L298N channel
+enum BridgeDirection {
+  BRIDGE_OFF,      // Both inputs low - motor coasts
+  BRIDGE_FORWARD,  // IN_A high, IN_B low
+  BRIDGE_REVERSE   // IN_A low, IN_B high
+};
+
+// On the Mega, digital pins 22-29 are PORTA bits 0-7 and pins 30-37 are
+// PORTC bits 7-0. Direction pins have to be on one of these two ports
+constexpr bool onPortA(uint8_t pin) {
+  return pin >= 22 && pin <= 29;
+}
+
+constexpr bool onPortC(uint8_t pin) {
+  return pin >= 30 && pin <= 37;
+}
+
+constexpr uint8_t portBit(uint8_t pin) {
+  return onPortA(pin) ? _BV(pin - 22) : _BV(37 - pin);
+}
+
+// One L298N channel with its pins fixed at compile time. Direction bits go
+// to the port in one halWritePort() instead of a digitalWrite per pin, and the
+// last commanded speed and direction are kept so repeats never reach the
+// hardware
+template <uint8_t EN, uint8_t IN_A, uint8_t IN_B>
+class HBridge {
+ public:
+  static_assert((onPortA(IN_A) && onPortA(IN_B)) ||
+                    (onPortC(IN_A) && onPortC(IN_B)),
+                "H-bridge direction pins must both be on PORTA or PORTC");
+
+  static constexpr bool ON_PORT_A = onPortA(IN_A);
+  static constexpr uint8_t MASK = portBit(IN_A) | portBit(IN_B);
+
+  // Port bits that select a direction
+  static constexpr uint8_t bits(BridgeDirection direction) {
+    return direction == BRIDGE_FORWARD   ? portBit(IN_A)
+           : direction == BRIDGE_REVERSE ? portBit(IN_B)
+                                         : 0;
+  }
+
+  static constexpr HalPort PORT = ON_PORT_A ? HAL_PORT_A : HAL_PORT_C;
+
+  // Enable pin and both direction pins as outputs, motor off
+  static void begin() {
+    halPinMode(EN, OUTPUT);
+    halAnalogWrite(EN, 0);
+    halWritePort(PORT, MASK, 0);
+    halSetPortOutputs(PORT, MASK);
+    speed = 0;
+    direction = BRIDGE_OFF;
+  }
+
+  static void setDirection(BridgeDirection newDirection) {
+    bool changed = newDirection != direction;
+    if (changed) {
+      direction = newDirection;
+      halWritePort(PORT, MASK, bits(direction));
+    }
+    countOutputWrite(changed);
+  }
+
+  static void setSpeed(int newSpeed) {
+    bool changed = newSpeed != speed;
+    if (changed) {
+      speed = newSpeed;
+      halAnalogWrite(EN, speed);
+    }
+    countOutputWrite(changed);
+  }
+
+  static int getSpeed() {
+    return speed;
+  }
+
+  static BridgeDirection getDirection() {
+    return direction;
+  }
+
+  // Shadow copies of what the hardware was last told
+  static int speed;
+  static BridgeDirection direction;
+};
+
+template <uint8_t EN, uint8_t IN_A, uint8_t IN_B>
+int HBridge<EN, IN_A, IN_B>::speed = 0;
+
+template <uint8_t EN, uint8_t IN_A, uint8_t IN_B>
+BridgeDirection HBridge<EN, IN_A, IN_B>::direction = BRIDGE_OFF;
+
+// Set two bridges on the same port with a single port write, so both change
+// direction at the same instant (e.g. the two drive wheels)
+template <class First, class Second>
+void setDirections(BridgeDirection first, BridgeDirection second) {
+  static_assert(First::ON_PORT_A == Second::ON_PORT_A,
+                "Paired H-bridges must share a port");
+  bool changed = first != First::direction || second != Second::direction;
+  if (changed) {
+    First::direction = first;
+    Second::direction = second;
+    halWritePort(First::PORT, First::MASK | Second::MASK,
+                 First::bits(first) | Second::bits(second));
+  }
+  countOutputWrite(changed);
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "log.h"
+
+static byte logBuffer[LOG_BUFFER_SIZE];
+const unsigned int logRamBytes = sizeof(logBuffer);
+static unsigned int logHead = 0;  // Next byte written
+static unsigned int logTail = 0;  // Next byte sent
+static unsigned int logDrops = 0;
+
+static unsigned int logFree() {
+  return (logTail - logHead - 1) & (LOG_BUFFER_SIZE - 1);
+}
+
+static bool recordFits(const LogRecord &record, byte bytes) {
+  return record.length + bytes <= LOG_RECORD_MAX;
+}
+
+void beginRecord(LogRecord &record, MessageId id) {
+  record.data[0] = LOG_RECORD_MAGIC;
+  record.data[1] = id;
+  record.length = 3;  // Argument byte count filled in by queue/write
+}
+
+// Zigzag varint: small numbers of either sign take one byte. Arguments that
+// no longer fit are left off; the decoder shows them as '?'
+void addInteger(LogRecord &record, long value) {
+  unsigned long zigzag = ((unsigned long)value << 1) ^ (value < 0 ? ~0UL : 0);
+  byte bytes[(sizeof(zigzag) * 8 + 6) / 7];
+  byte count = 0;
+  do {
+    bytes[count] = zigzag & 0x7F;
+    zigzag >>= 7;
+    if (zigzag) bytes[count] |= 0x80;
+    count++;
+  } while (zigzag);
+
+  if (!recordFits(record, count)) return;
+  memcpy(record.data + record.length, bytes, count);
+  record.length += count;
+}
+
+void addFloat(LogRecord &record, float value) {
+  if (!recordFits(record, sizeof(value))) return;
+  memcpy(record.data + record.length, &value, sizeof(value));
+  record.length += sizeof(value);
+}
+
+void addString(LogRecord &record, const char *text) {
+  byte length = min(strlen(text), (size_t)LOG_STRING_MAX);
+  if (!recordFits(record, 1 + length)) return;
+  record.data[record.length++] = length;
+  memcpy(record.data + record.length, text, length);
+  record.length += length;
+}
+
+static void finishRecord(LogRecord &record) {
+  record.data[2] = record.length - 3;
+}
+
+// Queue a whole record, or drop it if that would leave less than keepFree
+static void queueBytes(LogRecord &record, unsigned int keepFree) {
+  finishRecord(record);
+  if (record.length + keepFree > logFree()) {
+    logDrops++;
+    return;
+  }
+  for (byte i = 0; i < record.length; i++) {
+    logBuffer[logHead] = record.data[i];
+    logHead = (logHead + 1) & (LOG_BUFFER_SIZE - 1);
+  }
+}
+
+void queueRecord(LogRecord &record) {
+  queueBytes(record, LOG_REPORT_RESERVE);
+}
+
+void queueReport(LogRecord &record) {
+  queueBytes(record, 0);
+}
+
+// Hand Serial as much as fits in its transmit buffer right now. Called from
+// the main loop between scheduler passes; never waits for the UART
+void drainLog() {
+  int room = halUartAvailableForWrite(HAL_UART_DEBUG);
+  while (room > 0 && logTail != logHead) {
+    // Contiguous bytes up to the head or the end of the buffer
+    unsigned int end = logHead > logTail ? logHead : LOG_BUFFER_SIZE;
+    unsigned int count = min((unsigned int)room, end - logTail);
+    halUartWrite(HAL_UART_DEBUG, logBuffer + logTail, count);
+    logTail = (logTail + count) & (LOG_BUFFER_SIZE - 1);
+    room -= count;
+  }
+}
+
+// Records dropped because the buffer was full
+unsigned int getLogDrops() {
+  return logDrops;
+}
@@ -0,0 +1,136 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include "hal.h"
+
+// Log levels. Messages above LOG_LEVEL are compiled out entirely - their
+// arguments are never even evaluated
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4  // Per-command and per-chunk traces
+
+// Override with -DLOG_LEVEL=... in the PlatformIO build_flags
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Message ids, numbered from 0 in the order of the MESSAGE(...) entries in
+// messages.def
+enum MessageId {
+#define MESSAGE(id, format) id,
+#include "messages.def"
+#undef MESSAGE
+  MESSAGE_COUNT
+};
+
+static_assert(MESSAGE_COUNT <= 256, "Message ids are sent as one byte");
+
+// Binary log record on the USB serial port (tools/decode_log.py turns these
+// back into text):
+//   LOG_RECORD_MAGIC, message id, argument byte count, arguments
+// Integers are zigzag varints, floats 4 bytes little endian, strings a length
+// byte and the characters
+#define LOG_RECORD_MAGIC 0x1E  // ASCII record separator, never in log text
+#define LOG_RECORD_MAX 40
+#define LOG_STRING_MAX 24      // Longer string arguments are cut short
+
+// Records wait here until the USB serial port has room for them. A record
+// that does not fit is dropped (and counted) instead of blocking the caller.
+// Log messages leave LOG_REPORT_RESERVE bytes free, so a whole requested
+// report (status is about 300 bytes) still fits behind a burst of them
+#define LOG_BUFFER_SIZE 512  // Power of two
+#define LOG_REPORT_RESERVE 320
+
+struct LogRecord {
+  byte data[LOG_RECORD_MAX];
+  byte length;
+};
+
+void beginRecord(LogRecord &record, MessageId id);
+void addInteger(LogRecord &record, long value);
+void addFloat(LogRecord &record, float value);
+void addString(LogRecord &record, const char *text);
+void queueRecord(LogRecord &record);
+void queueReport(LogRecord &record);
+void drainLog();
+unsigned int getLogDrops();
+
+// Pick the encoding from the argument's type
+template <typename T>
+inline void addArgument(LogRecord &record, T value) {
+  addInteger(record, (long)value);
+}
+
+inline void addArgument(LogRecord &record, float value) {
+  addFloat(record, value);
+}
+
+inline void addArgument(LogRecord &record, double value) {
+  addFloat(record, value);
+}
+
+inline void addArgument(LogRecord &record, const char *text) {
+  addString(record, text);
+}
+
+inline void addArgument(LogRecord &record, char *text) {
+  addString(record, text);
+}
+
+inline void addArguments(LogRecord &) {}
+
+template <typename First, typename... Rest>
+inline void addArguments(LogRecord &record, First first, Rest... rest) {
+  addArgument(record, first);
+  addArguments(record, rest...);
+}
+
+// Queue a record for the background drain
+template <typename... Args>
+void logMessage(MessageId id, Args... args) {
+  LogRecord record;
+  beginRecord(record, id);
+  addArguments(record, args...);
+  queueRecord(record);
+}
+
+// Queue a record into the space kept for reports. Only for output somebody
+// asked for (startup banner, status report)
+template <typename... Args>
+void reportMessage(MessageId id, Args... args) {
+  LogRecord record;
+  beginRecord(record, id);
+  addArguments(record, args...);
+  queueReport(record);
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logMessage(__VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logMessage(__VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logMessage(__VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logMessage(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+// Static RAM of the queued log records (memory report)
+extern const unsigned int logRamBytes;
+
+#endif
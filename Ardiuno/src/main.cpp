@@ -1,11 +1,19 @@
-#include <Arduino.h>
+#include "hal.h"
 #include "config.h"
 #include "sensors.h"
 #include "motors.h"
 #include "rgb_led.h"
 #include "display.h"
+#include "log.h"
+#include "memory.h"
 #include "communication.h"
+#include "receiver.h"
+#include "reassembly.h"
 #include "navigation.h"
+#include "scheduler.h"
+#include "mapping.h"
+#include "motion.h"
+#include "telemetry.h"
 
 // Global variable definitions (declared as extern in config.h)
 // Motor speeds optimized for Arduino Mega (0-255 range)
@@ -15,57 +23,73 @@ long vacuumSpeed = 70;        // Higher speed for vacuum motor
 long mopSpeed = 140;          // Good speed for mop motor
 long pumpSpeed =160;          // Good speed for pump motor
 
+// Motor slew limits in PWM steps per second. Drive accel and decel are kept
+// equal so a timed move covers the same distance as an instant one would
+unsigned int driveAccelRate = 800;     // Full turn PWM in about 170 ms
+unsigned int driveDecelRate = 800;
+unsigned int cleaningAccelRate = 200;  // Pump reaches full speed in 0.8 s
+unsigned int cleaningDecelRate = 500;
+
+// Power budget: full-duty current of each motor (mA). Scaled by the PWM duty
+// cycle this is the current estimate the budget is checked against
+unsigned int driveMotorMa = 700;  // Per wheel
+unsigned int vacuumMotorMa = 1800;
+unsigned int mopMotorMa = 800;
+unsigned int pumpMotorMa = 600;
+
+// Current ceiling (mA) for everything together, per drive state. Hard turns
+// get the least headroom - that is where the battery sagged into brownouts
+unsigned int idleBudgetMa = 2500;
+unsigned int drivingBudgetMa = 2200;
+unsigned int turningBudgetMa = 1800;
+unsigned int reversingBudgetMa = 2000;
+
+// Spacing between coverage-mode lanes (a little under the cleaning width)
+long laneWidthCm = 20;
+
 // Robot mode state
 bool autoMode = false;  // Start in autonomous mode
-String currentCommand = "";
+FixedString<16> currentCommand;
 
 // Command chunking support for BLE
-ChunkBuffer chunkBuffer = {"", 0, 0, false, 0};
 const unsigned long CHUNK_TIMEOUT_MS = 5000;  // 5 second timeout for chunked commands
 
-// Motor A (Left motor) connections - First L298N
-int enA = 2;   // PWM pin for motor A speed control
-int in1 = 22;  // Motor A direction pin 1
-int in2 = 23;  // Motor A direction pin 2
-
-// Motor B (Right motor) connections - First L298N
-int enB = 3;   // PWM pin for motor B speed control
-int in3 = 24;  // Motor B direction pin 1
-int in4 = 25;  // Motor B direction pin 2
-
-// Second L298N Motor Driver for Vacuum motor only
-// Vacuum Motor (Motor C) connections
-int enC = 4;   // PWM pin for vacuum motor speed control
-int in5 = 26;  // Vacuum motor direction pin 1
-int in6 = 27;  // Vacuum motor direction pin 2
-
-// Third L298N Motor Driver for Mop and Pump motors
-// Mop Motor (Motor D) connections
-int enD = 5;   // PWM pin for mop motor speed control
-int in7 = 28;  // Mop motor direction pin 1
-int in8 = 29;  // Mop motor direction pin 2
-
-// Pump Motor (Motor E) connections - Third L298N
-int enE = 9;    // PWM pin for pump motor speed control
-int in9 = 30;   // Pump motor direction pin 1
-int in10 = 31;  // Pump motor direction pin 2
-
 // Control variables for mop, vacuum and pump
 bool mopEnabled = false;
 bool vacuumEnabled = false;
 bool pumpEnabled = false;
 
-// Sensor pins
+// Sensor pins (echo pins on A8-A12 so the PCINT2 interrupt can time them)
 int leftTrigPin = 32;
-int leftEchoPin = 33;
+int leftEchoPin = A8;
 int rightTrigPin = 34;
-int rightEchoPin = 35;
+int rightEchoPin = A9;
 int frontTrigPin = 36;
-int frontEchoPin = 37;
+int frontEchoPin = A10;
 int frontLeftTrigPin = 38;
-int frontLeftEchoPin = 39;
+int frontLeftEchoPin = A11;
 int frontRightTrigPin = 40;
-int frontRightEchoPin = 41;
+int frontRightEchoPin = A12;
+
+// Ultrasonic mounting angles in degrees (0 = straight ahead, negative = left)
+int leftSensorAngle = -90;
+int rightSensorAngle = 90;
+int frontSensorAngle = 0;
+int frontLeftSensorAngle = -45;
+int frontRightSensorAngle = 45;
+
+// Ultrasonic ping rates in Hz - front sensors matter most while driving
+unsigned int leftPingRate = 10;
+unsigned int rightPingRate = 10;
+unsigned int frontPingRate = 20;
+unsigned int frontLeftPingRate = 20;
+unsigned int frontRightPingRate = 20;
+
+// HC-SR04 beam is ~30 deg wide, so FL+R and FR+L (135 deg apart) can share a slot
+int crosstalkMinAngle = 135;
+
+// Robot drives at well under 1 m/s, so anything faster than this is a bad echo
+long maxDistanceRate = 150;
 
 // LED pin for obstacle detection
 int ledPin = 13;  // Using built-in LED on Arduino Mega (Pin 13)
@@ -74,63 +98,142 @@ int ledPin = 13;  // Using built-in LED on Arduino Mega (Pin 13)
 int rgbRedPin = 6;    // PWM pin for red
 int rgbGreenPin = 7;  // PWM pin for green
 int rgbBluePin = 8;   // PWM pin for blue
+
+// Variables for LED state management
+unsigned long lastIdleTime = 0;
+unsigned long idleCheckInterval = 30000;  // Check for idle every 30 seconds
+bool isIdle = false;
+
+// Sensors task: collect finished echoes and fire the next ping group. Runs
+// every tick, so a group goes out as soon as the last one's echoes are in;
+// one group per control period would cap ranging at 50 groups/s, short of
+// the 60 the default rates need
+void sensorsTask() {
+  updateRanging();
+}
+
+// Comms task: chunk resend requests and timeouts, BLE command intake
+void commsTask() {
+  // Ask for missing chunks of a stalled message, or give up on it
+  updateChunkReassembly();
+
+  // Hand over at most one complete frame - partial commands stay buffered
+  if (pollBLEReceiver()) {
+    lastIdleTime = halMillis();  // Reset idle timer on command processed
+  }
+}
+
+// Control task: idle detection, one navigation state machine tick and one
+// motor ramp step
+void controlTask() {
+  // Check for idle state (no commands or movement for a while)
+  if (!autoMode && (halMillis() - lastIdleTime > idleCheckInterval)) {
+    if (!isIdle) {
+      showIdleState();
+      isIdle = true;
+    }
+  } else {
+    isIdle = false;
+  }
+
+  // Start every autonomous run from a clean navigation state
+  static bool wasAutoMode = false;
+  if (autoMode && !wasAutoMode) {
+    resetNavigation();
+  }
+  wasAutoMode = autoMode;
+
+  // Fresh readings every pass in every mode - the LCD, telemetry, mapping
+  // and STATUS read the same snapshot. Each sensor is sampled at most once
+  // per pass
+  beginSensorCycle();
+
+  // A running calibration owns the motors until it finishes. Otherwise only
+  // run autonomous navigation if in auto mode
+  if (isCalibrating()) {
+    updateCalibration();
+  } else if (autoMode) {
+    autonomousNavigation();
+  }
+
+  // Slew the motors toward whatever was just commanded
+  updateMotorRamps();
+}
+
+// Mapping task: dead-reckoning pose and occupancy grid update
+void mappingTask() {
+  updateMap();
+}
+
+// LCD task: filtered distances and current mode
+void lcdTask() {
+  updateLCD(autoMode ? "AUTO" : "MANUAL", getSensorSnapshot());
+}
+
+// Telemetry task: stream state to the app at the rate it asked for
+void telemetryTask() {
+  updateTelemetry();
+}
+
+// Memory task: rescan the stack paint for the high-water mark
+void memoryTask() {
+  updateStackHighWater();
+}
+
+// LED task: advance non-blocking RGB effects
+void ledTask() {
+  updateRGBLED();
+}
+
+// Static task table: name, function, period (ms), priority, budget (us),
+// then the run-time fields initializeScheduler() resets
+Task tasks[] = {
+    {"comms", commsTask, 0, 4, 5000, 0, 0, 0},
+    {"sensors", sensorsTask, 0, 3, 500, 0, 0, 0},
+    {"control", controlTask, 20, 2, 2000, 0, 0, 0},
+    {"mapping", mappingTask, 100, 1, 4000, 0, 0, 0},
+    {"leds", ledTask, 33, 1, 500, 0, 0, 0},
+    {"telemetry", telemetryTask, 10, 1, 1500, 0, 0, 0},
+    {"lcd", lcdTask, 250, 0, 20000, 0, 0, 0},
+    {"memory", memoryTask, 1000, 0, 3000, 0, 0, 0},
+};
+
 void setup() {
+  // Mark free RAM before anything else runs, for the stack high-water mark
+  paintStack();
+
   // Initialize serial communication
-  Serial.begin(9600);  // Arduino Mega standard baud rate
+  halUartBegin(HAL_UART_DEBUG, 9600);  // Arduino Mega standard baud rate
 
   // Initialize HM-10 Serial3 module
-  Serial3.begin(9600);  // HM-10 default baud rate
-  Serial.println("HM-10 Serial3 initialized at 9600 baud");
+  halUartBegin(HAL_UART_BLE, 9600);  // HM-10 default baud rate
+  reportMessage(MSG_SERIAL3_READY);
 
   // Initialize LCD display
   initializeLCD();
 
-  // Set motor control pins as outputs (First L298N for movement)
-  pinMode(enA, OUTPUT);
-  pinMode(enB, OUTPUT);
-  pinMode(in1, OUTPUT);
-  pinMode(in2, OUTPUT);
-  pinMode(in3, OUTPUT);
-  pinMode(in4, OUTPUT);
-
-  // Set vacuum motor control pins as outputs (Second L298N)
-  pinMode(enC, OUTPUT);
-  pinMode(in5, OUTPUT);
-  pinMode(in6, OUTPUT);
-
-  // Set mop and pump motor control pins as outputs (Third L298N)
-  pinMode(enD, OUTPUT);
-  pinMode(enE, OUTPUT);
-  pinMode(in7, OUTPUT);
-  pinMode(in8, OUTPUT);
-  pinMode(in9, OUTPUT);
-  pinMode(in10, OUTPUT);
-
-  // Set ultrasonic sensor pins
-  pinMode(leftTrigPin, OUTPUT);
-  pinMode(leftEchoPin, INPUT);
-  pinMode(rightTrigPin, OUTPUT);
-  pinMode(rightEchoPin, INPUT);
-  pinMode(frontTrigPin, OUTPUT);
-  pinMode(frontEchoPin, INPUT);
-  pinMode(frontLeftTrigPin, OUTPUT);
-  pinMode(frontLeftEchoPin, INPUT);
-  pinMode(frontRightTrigPin, OUTPUT);
-  pinMode(frontRightEchoPin, INPUT);
+  // Set up all three L298N drivers with every motor off
+  initializeMotors();
+
+  // Set ultrasonic sensor pins and enable echo interrupts
+  initializeSensors();
+
+  // Measured drive/turn rates for this robot (or defaults)
+  loadMotionCalibration();
 
   // Set LED pin as output
-  pinMode(ledPin, OUTPUT);
-  digitalWrite(ledPin, LOW);  // Start with LED off
+  halPinMode(ledPin, OUTPUT);
+  halDigitalWrite(ledPin, LOW);  // Start with LED off
 
   // Set RGB LED pins as outputs
-  pinMode(rgbRedPin, OUTPUT);
-  pinMode(rgbGreenPin, OUTPUT);
-  pinMode(rgbBluePin, OUTPUT);
+  halPinMode(rgbRedPin, OUTPUT);
+  halPinMode(rgbGreenPin, OUTPUT);
+  halPinMode(rgbBluePin, OUTPUT);
   rgbOff();  // Start with RGB LED off
 
   // Show startup sequence
   setRGBColor(255, 0, 255);  // MAGENTA - Starting up
-  delay(1000);
+  halDelay(1000);
   showSystemState();  // Show initial system state
 
   // Turn off motors - Initial state
@@ -139,83 +242,18 @@ void setup() {
   // All cleaning motors start OFF - controlled via BLE commands
   stopCleaningMotors();
 
-  Serial.println("Arduino Mega Autonomous Cleaning Robot Started!");
-  Serial.println("All motors are initially OFF");
-  Serial.println(
-      "Use BLE commands: V_ON/V_OFF (vacuum), M_ON/M_OFF (mop), P_ON/P_OFF "
-      "(pump)");
-  Serial.println("Front ultrasonic sensor for obstacle detection");
-  Serial.println("RGB LED: RED=Obstacle detected, GREEN=Path clear");
-  Serial.println(
-      "Sensors: 5 Ultrasonic (front, left, right, front-left, front-right)");
+  reportMessage(MSG_STARTED);
+  reportMessage(MSG_MOTORS_OFF);
+  reportMessage(MSG_COMMAND_HELP);
+  reportMessage(MSG_FRONT_SENSOR_HELP);
+  reportMessage(MSG_LED_HELP);
+  reportMessage(MSG_SENSOR_HELP);
+
+  resetMap();  // Robot starts in the middle of the grid, facing +x
+  initializeScheduler(tasks, sizeof(tasks) / sizeof(tasks[0]));
 }
-// Variables for LED state management
-unsigned long lastIdleTime = 0;
-unsigned long idleCheckInterval = 30000;  // Check for idle every 30 seconds
-bool isIdle = false;
 
 void loop() {
-  // Check for and handle chunked command timeout
-  if (chunkBuffer.isActive && isChunkTimeout()) {
-    Serial.println("⚠️ Chunk timeout - resetting buffer");
-    resetChunkBuffer();
-  }
-
-  // Always check for BLE commands first and wait until command is processed
-  String tempCommand = "";
-  while (Serial3.available()) {
-    char c = Serial3.read();
-
-    // Check if this could be chunked binary data (first two bytes are chunk metadata)
-    if (tempCommand.length() == 0 && (c == 0 || c == 1 || c == 2)) {
-      // This might be chunked data - read the whole packet
-      byte chunkData[20];
-      chunkData[0] = c;
-      int bytesRead = 1;
-
-      // Read the rest of the packet
-      unsigned long startTime = millis();
-      while (bytesRead < 20 && (millis() - startTime < 100)) {
-        if (Serial3.available()) {
-          chunkData[bytesRead] = Serial3.read();
-          bytesRead++;
-        }
-      }
-
-      // Process chunked data
-      if (processChunkedData(chunkData, bytesRead)) {
-        // Complete command received and processed
-        lastIdleTime = millis();
-      }
-      return;  // Skip regular command processing for this loop
-    }
-
-    tempCommand += c;
-    delay(10);                // Small delay to allow complete command to arrive
-    lastIdleTime = millis();  // Reset idle timer on command received
-  }
-
-  if (tempCommand.length() > 0) {
-    Serial.println("📡 Received BLE command: " + tempCommand);
-    Serial.println("📏 Command length: " + String(tempCommand.length()));
-    processBLECommand(tempCommand);
-    lastIdleTime = millis();  // Reset idle timer on command processed
-  }
-
-  // Check for idle state (no commands or movement for a while)
-  if (!autoMode && (millis() - lastIdleTime > idleCheckInterval)) {
-    if (!isIdle) {
-      showIdleState();
-      isIdle = true;
-    }
-  } else {
-    isIdle = false;
-  }
-
-  // Only run autonomous navigation if in auto mode
-  if (autoMode) {
-    autonomousNavigation();
-  }
-
-  // delay(30);  // Fast loop for responsive control
+  runScheduler();
+  drainLog();  // Log output goes out only as fast as the UART takes it
 }
@@ -0,0 +1,157 @@
+#include "mapping.h"
+#include "config.h"
+#include "sensors.h"
+#include "motion.h"
+#include "motors.h"
+
+// 4 cells per byte, row-major
+static byte grid[GRID_SIZE * GRID_SIZE / 4];
+const unsigned int mappingRamBytes = sizeof(grid);
+static unsigned int cleanedCells = 0;
+
+static Pose pose = {0, 0, 0};
+static DriveMotion currentMotion = MOTION_STOPPED;
+static unsigned long lastPoseUpdate = 0;
+
+static int *const sensorAngleSettings[SENSOR_COUNT] = {
+    &leftSensorAngle, &rightSensorAngle, &frontSensorAngle,
+    &frontLeftSensorAngle, &frontRightSensorAngle};
+
+CellState getCell(int cellX, int cellY) {
+  if (cellX < 0 || cellY < 0 || cellX >= GRID_SIZE || cellY >= GRID_SIZE) {
+    return CELL_UNKNOWN;
+  }
+  unsigned int index = cellY * GRID_SIZE + cellX;
+  return (CellState)((grid[index / 4] >> ((index % 4) * 2)) & 0x03);
+}
+
+static void setCell(int cellX, int cellY, CellState state) {
+  if (cellX < 0 || cellY < 0 || cellX >= GRID_SIZE || cellY >= GRID_SIZE) {
+    return;  // Off the map
+  }
+  unsigned int index = cellY * GRID_SIZE + cellX;
+  byte shift = (index % 4) * 2;
+  CellState previous = (CellState)((grid[index / 4] >> shift) & 0x03);
+
+  if (previous == state) return;
+  if (state == CELL_CLEANED) cleanedCells++;
+  if (previous == CELL_CLEANED) cleanedCells--;
+
+  grid[index / 4] = (grid[index / 4] & ~(0x03 << shift)) | (state << shift);
+}
+
+// Pose (cm) to grid cell - the start position is the middle of the grid
+static int toCell(float cm) {
+  return (int)floor(cm / GRID_CELL_CM) + GRID_SIZE / 2;
+}
+
+void resetMap() {
+  memset(grid, 0, sizeof(grid));
+  cleanedCells = 0;
+  pose.x = 0;
+  pose.y = 0;
+  pose.heading = 0;
+  lastPoseUpdate = halMillis();
+}
+
+// Integrate the motion that has been running since the last update
+void updatePose() {
+  unsigned long now = halMillis();
+  float seconds = (now - lastPoseUpdate) / 1000.0;
+  lastPoseUpdate = now;
+
+  switch (currentMotion) {
+    case MOTION_FORWARD:
+    case MOTION_BACKWARD: {
+      float distance = linearRateAt(driveSpeed()) * seconds;
+      if (currentMotion == MOTION_BACKWARD) distance = -distance;
+      float radians = pose.heading * DEG_TO_RAD;
+      pose.x += distance * cos(radians);
+      pose.y += distance * sin(radians);
+      break;
+    }
+    case MOTION_TURN_LEFT:
+      pose.heading += angularRateAt(driveSpeed()) * seconds;
+      break;
+    case MOTION_TURN_RIGHT:
+      pose.heading -= angularRateAt(driveSpeed()) * seconds;
+      break;
+    case MOTION_STOPPED:
+      break;
+  }
+
+  // Keep heading in (-180, 180]
+  if (pose.heading > 180) pose.heading -= 360;
+  if (pose.heading <= -180) pose.heading += 360;
+}
+
+// Called by the motor ramp when the wheels change direction, so each motion
+// is integrated exactly up to the moment it changes
+void recordMotion(DriveMotion motion) {
+  updatePose();
+  currentMotion = motion;
+}
+
+const Pose &getPose() {
+  return pose;
+}
+
+// Mark cells along one sensor beam free, and the echo cell occupied
+static void traceRay(float angle, const SensorReading &reading) {
+  long distance = reading.distance;
+  bool hit = distance < SENSOR_MAX_RANGE_CM && distance <= MAP_RAY_MAX_CM;
+  if (distance > MAP_RAY_MAX_CM) distance = MAP_RAY_MAX_CM;
+
+  float radians = angle * DEG_TO_RAD;
+  float stepX = cos(radians) * GRID_CELL_CM;
+  float stepY = sin(radians) * GRID_CELL_CM;
+  float x = pose.x;
+  float y = pose.y;
+
+  // Free space up to (not including) the echo
+  for (long travelled = 0; travelled + GRID_CELL_CM <= distance;
+       travelled += GRID_CELL_CM) {
+    x += stepX;
+    y += stepY;
+    if (getCell(toCell(x), toCell(y)) != CELL_CLEANED) {
+      setCell(toCell(x), toCell(y), CELL_FREE);
+    }
+  }
+
+  if (hit) {
+    float endX = pose.x + cos(radians) * distance;
+    float endY = pose.y + sin(radians) * distance;
+    setCell(toCell(endX), toCell(endY), CELL_OCCUPIED);
+  }
+}
+
+// Bring the pose up to date and fold the latest sensor snapshot into the grid
+void updateMap() {
+  updatePose();
+
+  // The robot's footprint has been covered, and cleaned if a cleaning motor
+  // is running
+  bool cleaning = cleaningMotorsRunning();
+  int robotX = toCell(pose.x);
+  int robotY = toCell(pose.y);
+  for (int dy = -ROBOT_RADIUS_CELLS; dy <= ROBOT_RADIUS_CELLS; dy++) {
+    for (int dx = -ROBOT_RADIUS_CELLS; dx <= ROBOT_RADIUS_CELLS; dx++) {
+      if (cleaning) {
+        setCell(robotX + dx, robotY + dy, CELL_CLEANED);
+      } else if (getCell(robotX + dx, robotY + dy) != CELL_CLEANED) {
+        setCell(robotX + dx, robotY + dy, CELL_FREE);
+      }
+    }
+  }
+
+  const SensorSnapshot &snapshot = getSensorSnapshot();
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    if (!snapshot.readings[i].valid) continue;
+    // Sensor angles are negative to the left, heading is positive to the left
+    traceRay(pose.heading - *sensorAngleSettings[i], snapshot.readings[i]);
+  }
+}
+
+unsigned int getCleanedCells() {
+  return cleanedCells;
+}
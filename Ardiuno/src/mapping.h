@@ -0,0 +1,47 @@
+#ifndef MAPPING_H
+#define MAPPING_H
+
+#include "hal.h"
+
+// Occupancy grid: 2 bits per cell, robot starts in the middle
+#define GRID_SIZE 64       // Cells per side (64 x 64 x 2 bits = 1 KB)
+#define GRID_CELL_CM 10    // Cell edge length
+#define MAP_RAY_MAX_CM 150 // Readings beyond this only clear cells up to here
+#define ROBOT_RADIUS_CELLS 1
+
+enum CellState {
+  CELL_UNKNOWN,
+  CELL_FREE,      // Seen through by a sensor, or driven over not cleaning
+  CELL_OCCUPIED,  // A sensor got an echo from here
+  CELL_CLEANED    // Driven over with a cleaning motor running
+};
+
+// Drive motion the wheels are running (set by motors.cpp)
+enum DriveMotion {
+  MOTION_STOPPED,
+  MOTION_FORWARD,
+  MOTION_BACKWARD,
+  MOTION_TURN_LEFT,
+  MOTION_TURN_RIGHT
+};
+
+// Dead-reckoning pose relative to where the robot started
+struct Pose {
+  float x;        // cm, positive = initial forward direction
+  float y;        // cm, positive = initial left
+  float heading;  // degrees, counter-clockwise from the initial heading
+};
+
+// Function declarations for pose estimation and mapping
+void resetMap();
+void recordMotion(DriveMotion motion);
+void updatePose();
+const Pose &getPose();
+void updateMap();
+CellState getCell(int cellX, int cellY);
+unsigned int getCleanedCells();
+
+// Static RAM of the occupancy grid (memory report)
+extern const unsigned int mappingRamBytes;
+
+#endif
@@ -0,0 +1,104 @@
+#include "memory.h"
+#include "arena.h"
+#include "log.h"
+#include "mapping.h"
+#include "navigation.h"
+#include "reassembly.h"
+#include "receiver.h"
+#include "sensors.h"
+
+static const RamRegion ramRegions[] = {
+    {"BLE receive", receiverRamBytes}, {"chunks", reassemblyRamBytes},
+    {"JSON arenas", arenaRamBytes},    {"log", logRamBytes},
+    {"map", mappingRamBytes},          {"sensors", sensorsRamBytes},
+    {"navigation", navigationRamBytes},
+};
+
+static byte *lowestTouched = NULL;  // Deepest stack byte seen so far
+static MemoryStats stats;
+
+static byte *paintBottom() {
+  return halRamLayout().heapTop + STACK_PAINT_MARGIN;
+}
+
+// Fill everything between the heap and the live stack. Call first thing in
+// setup(), before the stack has been anywhere interesting
+void paintStack() {
+  byte *top = halStackPointer() - STACK_PAINT_MARGIN;
+  for (byte *p = paintBottom(); p < top; p++) {
+    *p = STACK_PAINT;
+  }
+  lowestTouched = top;
+}
+
+// Lowest byte above the heap that no longer holds the paint
+static byte *firstTouched() {
+  byte *p = paintBottom();
+  while (p < lowestTouched && *p == STACK_PAINT) p++;
+  return p;
+}
+
+// Scan for the stack's deepest point. About 1 ms per 2 KB of free RAM, so
+// this runs from a slow task rather than on every read
+void updateStackHighWater() {
+  if (!lowestTouched) return;
+  lowestTouched = firstTouched();
+}
+
+// Paint again from the deepest point so far up to the live stack and return
+// the top of the fresh paint. stackUsedBelow() then measures one operation
+// without losing the high-water mark since boot
+byte *repaintStack() {
+  updateStackHighWater();
+  byte *top = halStackPointer() - STACK_PAINT_MARGIN;
+  for (byte *p = lowestTouched; p < top; p++) {
+    *p = STACK_PAINT;
+  }
+  return top;
+}
+
+unsigned int stackUsedBelow(const byte *top) {
+  byte *p = paintBottom();
+  while (p < top && *p == STACK_PAINT) p++;
+  if (p < lowestTouched) lowestTouched = p;
+  return top - p;
+}
+
+const MemoryStats &getMemoryStats() {
+  HalRamLayout layout = halRamLayout();
+  stats.dataBytes = layout.dataEnd - layout.dataStart;
+  stats.bssBytes = layout.bssEnd - layout.bssStart;
+
+  halHeapFreeList(stats.heapFree, stats.heapFreeBlocks, stats.heapLargestFree);
+  stats.heapUsed = layout.heapTop - layout.heapStart - stats.heapFree;
+
+  byte *stack = halStackPointer();
+  stats.stackNow = layout.ramEnd - stack;
+  stats.freeNow = stack - layout.heapTop;
+  byte *lowest = lowestTouched ? lowestTouched : stack;
+  stats.stackPeak = layout.ramEnd - lowest;
+  stats.freeLowest = lowest - layout.heapTop;
+  return stats;
+}
+
+// Full memory report on Serial (the "memory" command)
+void printMemoryReport() {
+  updateStackHighWater();
+  const MemoryStats &memory = getMemoryStats();
+
+  reportMessage(MSG_MEMORY_BEGIN);
+  reportMessage(MSG_MEMORY_STATIC, memory.dataBytes + memory.bssBytes,
+                memory.dataBytes, memory.bssBytes);
+  unsigned int accounted = 0;
+  for (byte i = 0; i < sizeof(ramRegions) / sizeof(ramRegions[0]); i++) {
+    reportMessage(MSG_MEMORY_REGION, ramRegions[i].name, ramRegions[i].bytes);
+    accounted += ramRegions[i].bytes;
+  }
+  reportMessage(MSG_MEMORY_REGION, "other",
+                memory.dataBytes + memory.bssBytes - accounted);
+  reportMessage(MSG_MEMORY_STACK, memory.stackNow, memory.stackPeak);
+  reportMessage(MSG_MEMORY_FREE, memory.freeNow, memory.freeLowest);
+  reportMessage(MSG_MEMORY_HEAP, memory.heapUsed, memory.heapFree,
+                memory.heapFreeBlocks, memory.heapLargestFree);
+  reportMessage(MSG_MEMORY_END);
+}
@@ -0,0 +1,39 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include "hal.h"
+
+// Free RAM between the heap and the stack is filled with this at boot. Bytes
+// that still hold it were never touched, so the lowest changed byte marks
+// the deepest the stack has ever gone
+#define STACK_PAINT 0xC5
+#define STACK_PAINT_MARGIN 32  // Left untouched next to the heap and live stack
+
+struct MemoryStats {
+  unsigned int dataBytes;      // Initialised globals
+  unsigned int bssBytes;       // Zeroed globals
+  unsigned int heapUsed;       // 0 unless something brought malloc back
+  unsigned int heapFree;       // Sum of the free list
+  byte heapFreeBlocks;
+  unsigned int heapLargestFree;
+  unsigned int stackNow;       // Bytes below RAMEND in use right now
+  unsigned int stackPeak;      // Deepest since boot
+  unsigned int freeNow;        // Gap between heap and stack right now
+  unsigned int freeLowest;     // Smallest that gap has ever been
+};
+
+// A module's statically allocated RAM, for the memory report
+struct RamRegion {
+  const char *name;
+  const unsigned int &bytes;
+};
+
+// Function declarations for memory instrumentation
+void paintStack();
+void updateStackHighWater();
+byte *repaintStack();
+unsigned int stackUsedBelow(const byte *top);
+const MemoryStats &getMemoryStats();
+void printMemoryReport();
+
+#endif
@@ -0,0 +1,287 @@
+#include "motion.h"
+#include "config.h"
+#include "log.h"
+#include "motors.h"
+#include "sensors.h"
+
+// Uncalibrated defaults: rate grows linearly above a deadband, scaled to
+// 20 cm/s at the default drive PWM and 72 deg/s at the default turn PWM
+#define DEFAULT_DEADBAND_PWM 40
+#define DEFAULT_DRIVE_PWM 73
+#define DEFAULT_LINEAR_RATE 20.0
+#define DEFAULT_TURN_PWM 136
+#define DEFAULT_ANGULAR_RATE 72.0
+
+static MotionCalibration calibration;
+
+// Calibration routine steps
+#define CAL_IDLE 0
+#define CAL_SETTLE_BEFORE 1  // Stopped, waiting for a clean wall distance
+#define CAL_TURN 2           // Spinning left away from the wall
+#define CAL_SETTLE_AFTER 3   // Stopped, waiting for the new wall distance
+#define CAL_RETURN 4         // Spinning back to face the same way again
+
+static byte calState = CAL_IDLE;
+static byte calLevel = 0;
+static unsigned long calDeadline = 0;
+static unsigned int calTurnMs = 0;
+static bool calTurnTimed = false;  // Turn clock started with the wheels
+static long calStartDistance = 0;
+static byte calRetries = 0;  // Settle periods without a wall reading
+static byte calFailed = 0;   // Levels without a usable reading
+static long calSavedSpeed = 0;
+
+static void setDefaultCalibration() {
+  static const byte levels[CALIBRATION_LEVELS] = {60, 90, 120, 150, 190, 255};
+
+  calibration.magic = 0;
+  for (byte i = 0; i < CALIBRATION_LEVELS; i++) {
+    float aboveDeadband = levels[i] - DEFAULT_DEADBAND_PWM;
+    calibration.pwm[i] = levels[i];
+    calibration.linear[i] = DEFAULT_LINEAR_RATE * aboveDeadband /
+                            (DEFAULT_DRIVE_PWM - DEFAULT_DEADBAND_PWM);
+    calibration.angular[i] = DEFAULT_ANGULAR_RATE * aboveDeadband /
+                             (DEFAULT_TURN_PWM - DEFAULT_DEADBAND_PWM);
+  }
+}
+
+// Use this robot's measured table from EEPROM if there is one
+void loadMotionCalibration() {
+  halEepromRead(CALIBRATION_EEPROM_ADDR, &calibration, sizeof(calibration));
+  if (calibration.magic != CALIBRATION_MAGIC) {
+    setDefaultCalibration();
+    LOG_WARN(MSG_NO_CALIBRATION);
+  } else {
+    LOG_INFO(MSG_CALIBRATION_LOADED);
+  }
+}
+
+// Piecewise-linear lookup of a rate column at a PWM level (down to 0 at
+// PWM 0, for wheels that are still ramping)
+static float interpolate(const float *rates, int pwm) {
+  if (pwm <= 0) return 0;
+  if (pwm <= calibration.pwm[0]) return rates[0] * pwm / calibration.pwm[0];
+
+  for (byte i = 1; i < CALIBRATION_LEVELS; i++) {
+    if (pwm <= calibration.pwm[i]) {
+      float span = calibration.pwm[i] - calibration.pwm[i - 1];
+      float t = (pwm - calibration.pwm[i - 1]) / span;
+      return rates[i - 1] + t * (rates[i] - rates[i - 1]);
+    }
+  }
+  return rates[CALIBRATION_LEVELS - 1];
+}
+
+// Straight-line speed (cm/s) at the current drive PWM
+float linearRate() {
+  return linearRateAt(drivePWM());
+}
+
+// Spin rate (deg/s) at the current turn PWM
+float angularRate() {
+  return angularRateAt(turnPWM());
+}
+
+float linearRateAt(int pwm) {
+  return interpolate(calibration.linear, pwm);
+}
+
+float angularRateAt(int pwm) {
+  return interpolate(calibration.angular, pwm);
+}
+
+// How long to command a move that takes fullRateMs at full rate. The step
+// is timed from the wheels starting, so the ramp up loses ground and the ramp
+// down after the stop makes some back; a move too short to reach full speed
+// covers a triangle instead, whose area grows with the square of the time
+static unsigned int rampedDurationMs(float fullRateMs, int pwm) {
+  float upMs = pwm * 1000.0 / driveAccelRate;
+  float downMs = pwm * 1000.0 / driveDecelRate;
+  if (fullRateMs >= (upMs + downMs) / 2) {
+    return fullRateMs + (upMs - downMs) / 2;
+  }
+  return upMs * sqrt(2 * fullRateMs / (upMs + downMs));
+}
+
+unsigned int driveDurationMs(float cm) {
+  float rate = linearRate();
+  if (rate <= 0) return 0;
+  return rampedDurationMs(fabs(cm) / rate * 1000, drivePWM());
+}
+
+unsigned int rotateDurationMs(float degrees) {
+  float rate = angularRate();
+  if (rate <= 0) return 0;
+  return rampedDurationMs(fabs(degrees) / rate * 1000, turnPWM());
+}
+
+// Start driving (positive = forward) and return how long the move takes;
+// the caller stops the motors when that time is up
+unsigned int driveFor(float cm) {
+  if (cm >= 0) {
+    moveForward();
+  } else {
+    moveBackward();
+  }
+  return driveDurationMs(cm);
+}
+
+// Start spinning (positive = left/counter-clockwise) and return how long the
+// rotation takes; the caller stops the motors when that time is up
+unsigned int rotateBy(float degrees) {
+  if (degrees >= 0) {
+    turnLeft();
+  } else {
+    turnRight();
+  }
+  return rotateDurationMs(degrees);
+}
+
+// Run each PWM level at the turn speed for that level
+static void setCalibrationLevel(byte level) {
+  motorSpeed = (calibration.pwm[level] + 1) / 1.7;
+  calibration.pwm[level] = turnPWM();  // Record the PWM actually produced
+  calState = CAL_SETTLE_BEFORE;
+  calRetries = 0;
+  calDeadline = halMillis() + CALIBRATION_SETTLE_MS;
+}
+
+// Needs manual mode and a wall 10-60 cm away, square to the right sensor
+bool startTurnCalibration() {
+  if (isCalibrating()) return false;
+
+  beginSensorCycle();
+  const SensorReading &right = readSensor(SENSOR_RIGHT);
+
+  if (autoMode || !right.valid || right.distance < CALIBRATION_MIN_WALL_CM ||
+      right.distance > CALIBRATION_MAX_WALL_CM) {
+    LOG_ERROR(MSG_CALIBRATION_NO_WALL);
+    return false;
+  }
+
+  LOG_INFO(MSG_CALIBRATION_STARTED);
+  stopMotors();
+  calSavedSpeed = motorSpeed;
+  calLevel = 0;
+  calFailed = 0;
+  setCalibrationLevel(0);
+  return true;
+}
+
+bool isCalibrating() {
+  return calState != CAL_IDLE;
+}
+
+// Abandon a calibration run without saving anything
+void cancelCalibration() {
+  if (calState == CAL_IDLE) return;
+  stopMotors();
+  motorSpeed = calSavedSpeed;
+  loadMotionCalibration();  // Drop the partly measured table
+  calState = CAL_IDLE;
+  LOG_WARN(MSG_CALIBRATION_CANCELLED);
+}
+
+// Measurement turns run for a fixed time, uncompensated, and at least as long
+// as the ramp up so the wheels reach steady speed
+static unsigned int calibrationTurnMs() {
+  float rate = angularRate();
+  float upMs = turnPWM() * 1000.0 / driveAccelRate;
+  float fullRateMs = rate > 0 ? CALIBRATION_ANGLE / rate * 1000 : 0;
+  return max(fullRateMs, upMs + CALIBRATION_STEADY_MS);
+}
+
+// Spin rate from the angle a calibration turn covered. The ramp up loses
+// half its time at full rate and the ramp down after the stop makes half
+// of its own back
+static float measuredRate(float angle) {
+  float upMs = turnPWM() * 1000.0 / driveAccelRate;
+  float downMs = turnPWM() * 1000.0 / driveDecelRate;
+  return angle * 1000.0 / (calTurnMs + (downMs - upMs) / 2);
+}
+
+// Spin for calTurnMs, timed from the wheels actually starting
+static void startCalibrationTurn(byte state) {
+  if (state == CAL_TURN) {
+    turnLeft();
+  } else {
+    turnRight();
+  }
+  calState = state;
+  calTurnTimed = false;
+  calDeadline = halMillis();
+}
+
+// Advance the calibration routine; the wall distance grows as d0 / cos(angle)
+void updateCalibration() {
+  if (calState == CAL_IDLE || (long)(halMillis() - calDeadline) < 0) return;
+
+  if ((calState == CAL_TURN || calState == CAL_RETURN) && !calTurnTimed) {
+    if (!driveStarted()) return;
+    calTurnTimed = true;
+    calDeadline = halMillis() + calTurnMs;
+    return;
+  }
+
+  const SensorReading &right = readSensor(SENSOR_RIGHT);
+
+  switch (calState) {
+    case CAL_SETTLE_BEFORE:
+      if (!right.valid) {
+        // Lost the wall while settling - wait for it, then give up
+        if (++calRetries > CALIBRATION_MAX_RETRIES) {
+          LOG_ERROR(MSG_CALIBRATION_NO_WALL);
+          cancelCalibration();
+          break;
+        }
+        calDeadline = halMillis() + CALIBRATION_SETTLE_MS;
+        break;
+      }
+      calRetries = 0;
+      calStartDistance = right.distance;
+      calTurnMs = calibrationTurnMs();
+      startCalibrationTurn(CAL_TURN);
+      break;
+
+    case CAL_TURN:
+      stopMotors();
+      calState = CAL_SETTLE_AFTER;
+      calDeadline = halMillis() + CALIBRATION_SETTLE_MS;
+      break;
+
+    case CAL_SETTLE_AFTER:
+      if (right.valid && right.distance > calStartDistance) {
+        float angle = acos((float)calStartDistance / right.distance) * RAD_TO_DEG;
+        calibration.angular[calLevel] = measuredRate(angle);
+        LOG_INFO(MSG_CALIBRATION_LEVEL, calibration.pwm[calLevel],
+                 calibration.angular[calLevel]);
+      } else {
+        LOG_WARN(MSG_CALIBRATION_BAD_READING, calibration.pwm[calLevel]);
+        calFailed++;
+      }
+      startCalibrationTurn(CAL_RETURN);
+      break;
+
+    case CAL_RETURN:
+      stopMotors();
+      if (++calLevel < CALIBRATION_LEVELS) {
+        setCalibrationLevel(calLevel);
+        break;
+      }
+
+      motorSpeed = calSavedSpeed;
+      calState = CAL_IDLE;
+      if (calFailed > 0) {
+        // A part-measured table is used until reset but never saved
+        LOG_WARN(MSG_CALIBRATION_NOT_SAVED, calFailed);
+        break;
+      }
+
+      // All levels measured - keep them for this robot
+      calibration.magic = CALIBRATION_MAGIC;
+      halEepromWrite(CALIBRATION_EEPROM_ADDR, &calibration,
+                     sizeof(calibration));
+      LOG_INFO(MSG_CALIBRATION_SAVED);
+      break;
+  }
+}
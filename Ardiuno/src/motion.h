@@ -0,0 +1,43 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "hal.h"
+
+// Calibration table: measured rates at a handful of PWM levels
+#define CALIBRATION_LEVELS 6
+#define CALIBRATION_EEPROM_ADDR 0
+#define CALIBRATION_MAGIC 0xCA1B
+
+// Turn-rate calibration: spin away from a wall on the right, then back
+#define CALIBRATION_SETTLE_MS 1000  // Long enough for the median to catch up
+#define CALIBRATION_ANGLE 25        // Target test angle in degrees
+#define CALIBRATION_MIN_WALL_CM 10
+#define CALIBRATION_MAX_WALL_CM 60
+#define CALIBRATION_MAX_RETRIES 2   // Extra settle periods to find the wall
+#define CALIBRATION_STEADY_MS 200   // Least time a test turn runs at full rate
+
+struct MotionCalibration {
+  unsigned int magic;                 // CALIBRATION_MAGIC once saved
+  byte pwm[CALIBRATION_LEVELS];       // PWM levels, ascending
+  float linear[CALIBRATION_LEVELS];   // cm/s driving straight at that PWM
+  float angular[CALIBRATION_LEVELS];  // deg/s spinning in place at that PWM
+};
+
+// Function declarations for calibrated motion primitives
+void loadMotionCalibration();
+float linearRate();
+float angularRate();
+float linearRateAt(int pwm);
+float angularRateAt(int pwm);
+unsigned int driveDurationMs(float cm);
+unsigned int rotateDurationMs(float degrees);
+unsigned int driveFor(float cm);
+unsigned int rotateBy(float degrees);
+
+// Turn-rate calibration routine (runs from the control task)
+bool startTurnCalibration();
+bool isCalibrating();
+void cancelCalibration();
+void updateCalibration();
+
+#endif
@@ -2,159 +2,196 @@
 #include "config.h"
 #include "display.h"
 #include "rgb_led.h"
+#include "mapping.h"
+#include "hbridge.h"
+#include "power.h"
+#include "log.h"
 
-void stopMotors() {
-  // Stop main drive motors (First L298N)
-  digitalWrite(in1, LOW);
-  digitalWrite(in2, LOW);
-  digitalWrite(in3, LOW);
-  digitalWrite(in4, LOW);
-  analogWrite(enA, 0);
-  analogWrite(enB, 0);
-
-  // Restore full cleaning motor speeds when not driving
-  if (vacuumEnabled) {
-    analogWrite(enC, vacuumSpeed);  // Restore vacuum speed (Second L298N)
-  }
-  if (mopEnabled) {
-    analogWrite(enD, mopSpeed);  // Restore mop speed (Third L298N)
-  }
-  if (pumpEnabled) {
-    analogWrite(enE, pumpSpeed);  // Restore pump speed (Third L298N)
-  }
+// Drive wheels are wired so that in2/in4 high is forward
+typedef HBridge<enA, in2, in1> LeftWheel;
+typedef HBridge<enB, in4, in3> RightWheel;
+typedef HBridge<enC, in5, in6> Vacuum;
+typedef HBridge<enD, in7, in8> Mop;
+typedef HBridge<enE, in9, in10> Pump;
+
+void initializeMotors() {
+  LeftWheel::begin();
+  RightWheel::begin();
+  Vacuum::begin();
+  Mop::begin();
+  Pump::begin();
+}
+
+// Drive PWM for straight runs and for spins in place at the current motorSpeed
+int drivePWM() {
+  return motorSpeed / 1.1;
 }
 
+int turnPWM() {
+  return min(motorSpeed * 1.7, 255.0);
+}
 
-// Motor control functions with power management
-void moveForward() {
-  // Reduce cleaning motor speeds when driving to save power
-  if (vacuumEnabled) {
-    analogWrite(enC, vacuumSpeed);  // Reduce vacuum speed to 80%
-  }
-  if (mopEnabled) {
-    analogWrite(enD, mopSpeed);  // Reduce mop speed to 70%
-  }
-  if (pumpEnabled) {
-    analogWrite(enE, pumpSpeed);  // Reduce pump speed to 70%
-  }
+// Drive commands set a target; updateMotorRamps() slews the wheels to it.
+// Both wheels always share one PWM, so a single target speed covers both
+static BridgeDirection leftTarget = BRIDGE_OFF;
+static BridgeDirection rightTarget = BRIDGE_OFF;
+static int driveTarget = 0;
+static unsigned long lastRampUpdate = 0;
 
-  analogWrite(enA, motorSpeed / 1.1);
-  analogWrite(enB, motorSpeed / 1.1);
-  digitalWrite(in1, LOW);
-  digitalWrite(in2, HIGH);
-  digitalWrite(in3, LOW);
-  digitalWrite(in4, HIGH);
+static void commandDrive(BridgeDirection left, BridgeDirection right, int pwm) {
+  leftTarget = left;
+  rightTarget = right;
+  driveTarget = pwm;
 }
 
-void moveBackward() {
-  // Reduce cleaning motor speeds when driving to save power
-  if (vacuumEnabled) {
-    analogWrite(enC, vacuumSpeed);  // Reduce vacuum speed to 80%
-  }
-  if (mopEnabled) {
-    analogWrite(enD, mopSpeed);  // Reduce mop speed to 70%
-  }
-  if (pumpEnabled) {
-    analogWrite(enE, pumpSpeed);  // Reduce pump speed to 70%
+// What a pair of wheel directions does to the robot
+static DriveMotion wheelMotion(BridgeDirection left, BridgeDirection right) {
+  if (left == BRIDGE_OFF) return MOTION_STOPPED;
+  if (left == right) {
+    return left == BRIDGE_FORWARD ? MOTION_FORWARD : MOTION_BACKWARD;
   }
+  return left == BRIDGE_REVERSE ? MOTION_TURN_LEFT : MOTION_TURN_RIGHT;
+}
 
-  analogWrite(enA, motorSpeed / 1.1);
-  analogWrite(enB, motorSpeed / 1.1);
-  digitalWrite(in1, HIGH);
-  digitalWrite(in2, LOW);
-  digitalWrite(in3, HIGH);
-  digitalWrite(in4, LOW);
+void stopMotors() {
+  // Stop main drive motors (First L298N)
+  commandDrive(BRIDGE_OFF, BRIDGE_OFF, 0);
 }
 
-void turnLeft() {
-  // Reduce cleaning motor speeds when turning to save power
-  if (vacuumEnabled) {
-    analogWrite(enC, vacuumSpeed);  // Reduce vacuum speed to 70%
-  }
-  if (mopEnabled) {
-    analogWrite(enD, mopSpeed);  // Reduce mop speed to 60%
-  }
-  if (pumpEnabled) {
-    analogWrite(enE, pumpSpeed);  // Reduce pump speed to 60%
-  }
+// Motor control functions - the wheels ramp to speed on the control tick, and
+// dead reckoning follows the wheels rather than the command
+void moveForward() {
+  commandDrive(BRIDGE_FORWARD, BRIDGE_FORWARD, drivePWM());
+}
 
-  analogWrite(enA, motorSpeed * 1.7);
-  analogWrite(enB, motorSpeed * 1.7);
+void moveBackward() {
+  commandDrive(BRIDGE_REVERSE, BRIDGE_REVERSE, drivePWM());
+}
+
+void turnLeft() {
   // SWAPPED: Left motor backward, right motor forward (to turn left)
-  digitalWrite(in1, HIGH);
-  digitalWrite(in2, LOW);
-  digitalWrite(in3, LOW);
-  digitalWrite(in4, HIGH);
+  commandDrive(BRIDGE_REVERSE, BRIDGE_FORWARD, turnPWM());
 }
 
 void turnRight() {
-  // Reduce cleaning motor speeds when turning to save power
-  if (vacuumEnabled) {
-    analogWrite(enC, vacuumSpeed);  // Reduce vacuum speed to 70%
-  }
-  if (mopEnabled) {
-    analogWrite(enD, mopSpeed);  // Reduce mop speed to 60%
-  }
-  if (pumpEnabled) {
-    analogWrite(enE, pumpSpeed);  // Reduce pump speed to 60%
+  // SWAPPED: Left motor forward, right motor backward (to turn right)
+  commandDrive(BRIDGE_FORWARD, BRIDGE_REVERSE, turnPWM());
+}
+
+// Move a PWM value toward a target by at most one step up or down
+static int slew(int current, int target, int up, int down) {
+  if (target > current) return min(current + up, target);
+  return max(current - down, target);
+}
+
+// Ramp the drive wheels. A direction change first ramps down to zero, then
+// flips both wheels together. Returns true while speeding up
+static bool rampDrive(int target, int up, int down) {
+  if (LeftWheel::direction != leftTarget ||
+      RightWheel::direction != rightTarget) {
+    int speed = slew(LeftWheel::speed, 0, up, down);
+    LeftWheel::setSpeed(speed);
+    RightWheel::setSpeed(speed);
+    if (speed > 0) return false;
+    setDirections<LeftWheel, RightWheel>(leftTarget, rightTarget);
+    recordMotion(wheelMotion(leftTarget, rightTarget));
   }
 
-  analogWrite(enA, motorSpeed * 1.7);
-  analogWrite(enB, motorSpeed * 1.7);
-  // SWAPPED: Left motor forward, right motor backward (to turn right)
-  digitalWrite(in1, LOW);
-  digitalWrite(in2, HIGH);
-  digitalWrite(in3, HIGH);
-  digitalWrite(in4, LOW);
+  int speed = slew(LeftWheel::speed, target, up, down);
+  LeftWheel::setSpeed(speed);
+  RightWheel::setSpeed(speed);
+  return speed < target;
+}
+
+// True once the wheels run the commanded way round (a reversal or a turn is
+// only under way after the ramp down and the flip)
+bool driveStarted() {
+  return LeftWheel::direction == leftTarget &&
+         RightWheel::direction == rightTarget;
+}
+
+// Current drive PWM of the wheels, mid-ramp included
+int driveSpeed() {
+  return LeftWheel::speed;
+}
+
+// True while any cleaning motor turns, ramps included
+bool cleaningMotorsRunning() {
+  return Vacuum::speed > 0 || Mop::speed > 0 || Pump::speed > 0;
 }
 
-// Cleaning Motor Control Functions
+// Soft start/stop for one cleaning motor. While hold is set (something else
+// is speeding up) it waits, so inrush currents never stack
+template <class Bridge>
+static bool rampCleaning(int target, int up, int down, bool hold) {
+  if (Bridge::speed < target && hold) return true;
+
+  if (target > 0) Bridge::setDirection(BRIDGE_FORWARD);
+  int speed = slew(Bridge::speed, target, up, down);
+  Bridge::setSpeed(speed);
+  if (speed == 0) Bridge::setDirection(BRIDGE_OFF);
+  return speed < target;
+}
+
+// One slew step for every channel, run from the control task
+void updateMotorRamps() {
+  updatePose();  // Integrate the last step at the speed the wheels ran at
+
+  unsigned long now = halMillis();
+  unsigned long elapsed = min(now - lastRampUpdate, RAMP_MAX_STEP_MS);
+  lastRampUpdate = now;
+
+  int driveUp = max(driveAccelRate * elapsed / 1000, 1UL);
+  int driveDown = max(driveDecelRate * elapsed / 1000, 1UL);
+  int cleaningUp = max(cleaningAccelRate * elapsed / 1000, 1UL);
+  int cleaningDown = max(cleaningDecelRate * elapsed / 1000, 1UL);
+
+  // Ramp toward the targets the power budget allows for this drive state
+  PowerState state = driveTarget == 0              ? POWER_IDLE
+                     : leftTarget != rightTarget    ? POWER_TURNING
+                     : leftTarget == BRIDGE_REVERSE ? POWER_REVERSING
+                                                    : POWER_DRIVING;
+  const PowerAllocation &power = allocatePower(
+      state, driveTarget, vacuumEnabled ? vacuumSpeed : 0,
+      mopEnabled ? mopSpeed : 0, pumpEnabled ? pumpSpeed : 0);
+
+  // Drive first, then the cleaning motors one after another
+  bool starting = rampDrive(power.drive, driveUp, driveDown);
+  starting |= rampCleaning<Vacuum>(power.vacuum, cleaningUp, cleaningDown,
+                                   starting);
+  starting |= rampCleaning<Mop>(power.mop, cleaningUp, cleaningDown, starting);
+  rampCleaning<Pump>(power.pump, cleaningUp, cleaningDown, starting);
+}
+
+// Cleaning Motor Control Functions - updateMotorRamps() soft-starts them
 void startVacuum() {
-  analogWrite(enC, vacuumSpeed);  // Second L298N - Motor C is now vacuum
-  digitalWrite(in5, HIGH);
-  digitalWrite(in6, LOW);
   vacuumEnabled = true;
-  Serial.println("Vacuum motor started");
+  LOG_DEBUG(MSG_MOTOR, "Vacuum", "started");
 }
 
 void stopVacuum() {
-  analogWrite(enC, 0);  // Second L298N - Motor C is now vacuum
-  digitalWrite(in5, LOW);
-  digitalWrite(in6, LOW);
   vacuumEnabled = false;
-  Serial.println("Vacuum motor stopped");
+  LOG_DEBUG(MSG_MOTOR, "Vacuum", "stopped");
 }
 
 void startMop() {
-  analogWrite(enD, mopSpeed);  // Third L298N - Motor D is now mop
-  digitalWrite(in7, HIGH);
-  digitalWrite(in8, LOW);
   mopEnabled = true;
-  Serial.println("Mop motor started");
+  LOG_DEBUG(MSG_MOTOR, "Mop", "started");
 }
 
 void stopMop() {
-  analogWrite(enD, 0);  // Third L298N - Motor D is now mop
-  digitalWrite(in7, LOW);
-  digitalWrite(in8, LOW);
   mopEnabled = false;
-  Serial.println("Mop motor stopped");
+  LOG_DEBUG(MSG_MOTOR, "Mop", "stopped");
 }
 
 void startPump() {
-  analogWrite(enE, pumpSpeed);  // Third L298N - Motor E is pump
-  digitalWrite(in9, HIGH);
-  digitalWrite(in10, LOW);
   pumpEnabled = true;
-  Serial.println("Pump motor started");
+  LOG_DEBUG(MSG_MOTOR, "Pump", "started");
 }
 
 void stopPump() {
-  analogWrite(enE, 0);  // Third L298N - Motor E is pump
-  digitalWrite(in9, LOW);
-  digitalWrite(in10, LOW);
   pumpEnabled = false;
-  Serial.println("Pump motor stopped");
+  LOG_DEBUG(MSG_MOTOR, "Pump", "stopped");
 }
 
 void toggleVacuum() {
@@ -185,44 +222,5 @@ void stopCleaningMotors() {
   stopMop();
   stopVacuum();
   stopPump();
-  Serial.println("All cleaning motors stopped");
-}
-
-// Dedicated 180-degree turn function
-void turn180Degrees() {
-  
-
-  // Back up first to create turning space
-  moveBackward();
-  delay(500);  // Back up for half a second
-  stopMotors();
-  delay(200);
-
-  // Flash RGB to indicate 180-turn in progress with warning pattern
-  for (int i = 0; i < 3; i++) {
-    setRGBColor(255, 0, 255);  // MAGENTA
-    delay(200);
-    setRGBColor(255, 255, 0);  // YELLOW
-    delay(200);
-  }
-  setRGBColor(255, 0, 255);  // MAGENTA - 180 turn in progress
-
-  // Perform the 180-degree turn - ignore all sensor readings during this turn
-  turnRight();  // Turn right for 180 degrees
-
-  // Turn for a longer time to ensure full 180 degrees
-  delay(2500);  // 3.5 seconds for more reliable 180-degree turn
-
-  stopMotors();
-  delay(300);  // Brief pause after turn
-
-  // Turn complete - show success pattern
-  for (int i = 0; i < 3; i++) {
-    setRGBColor(0, 255, 0);  // GREEN - Success
-    delay(150);
-    rgbOff();
-    delay(150);
-  }
-  setRGBColor(0, 255, 0);  // GREEN - Turn completed
-  showSystemState();  // Return to normal system state
+  LOG_DEBUG(MSG_CLEANING_STOPPED);
 }
@@ -1,15 +1,24 @@
 #ifndef MOTORS_H
 #define MOTORS_H
 
-#include <Arduino.h>
+#include "hal.h"
+
+// Longest time one ramp step may cover, so a stalled loop cannot jump a motor
+// straight to full speed
+#define RAMP_MAX_STEP_MS 40UL
 
 // Function declarations for motor control
+void initializeMotors();
 void stopMotors();
 void moveForward();
 void moveBackward();
 void turnLeft();
 void turnRight();
-void turn180Degrees();
+void updateMotorRamps();
+int drivePWM();
+int turnPWM();
+bool driveStarted();
+int driveSpeed();
 
 // Cleaning motor function declarations
 void startMop();
@@ -22,5 +31,6 @@ void toggleMop();
 void toggleVacuum();
 void togglePump();
 void stopCleaningMotors();
+bool cleaningMotorsRunning();
 
 #endif
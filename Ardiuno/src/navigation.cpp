@@ -4,248 +4,476 @@
 #include "motors.h"
 #include "rgb_led.h"
 #include "display.h"
+#include "decisions.h"
+#include "mapping.h"
+#include "motion.h"
 
-// Obstacle avoidance logic
-void avoidObstacle() {
-  updateLCD("OBSTACLE!", 0, 0, 0, 0, 0);
-  stopMotors();
-  delay(500);
-
-  // Check all sensors (5 ultrasonic sensors)
-  int leftDistance = getDistance(leftTrigPin, leftEchoPin);
-  delay(50);
-  int rightDistance = getDistance(rightTrigPin, rightEchoPin);
-  delay(50);
-  int frontDistance = getFrontDistance();  // Use ultrasonic sensor function
-  delay(50);                               // Standard ultrasonic delay
-  int frontLeftDistance = getDistance(frontLeftTrigPin, frontLeftEchoPin);
-  delay(50);
-  int frontRightDistance = getDistance(frontRightTrigPin, frontRightEchoPin);
-  delay(50);
-
-  // Enhanced decision making based on all sensors
-  // Check if left side is clear (both left and front-left)
-  if (leftDistance > obstacleThreshold &&
-      frontLeftDistance > obstacleThreshold) {
-    // TURNING LEFT
-    turnLeft();
-    delay(300);
-    stopMotors();
-    return;
+// One step of a manoeuvre. The amount is degrees for turns, cm for backing up
+// and driving, and ms for everything else
+struct NavStep {
+  NavState state;
+  unsigned int amount;
+};
+
+#define MAX_PLAN_STEPS 4
+
+// Coverage lane transitions, applied when the current plan finishes
+#define LANE_NONE 0
+#define LANE_NEXT 1     // Lane change done - run the next lane
+#define LANE_RESTART 2  // Escaped a tight spot - start lanes afresh
+
+// Navigation state machine - advanced once per loop() tick, never blocks
+static NavState navState = NAV_FORWARD;
+static NavStep plan[MAX_PLAN_STEPS];  // Manoeuvre being executed
+static byte planLength = 0;
+static byte planIndex = 0;
+const unsigned int navigationRamBytes = sizeof(plan);
+static unsigned long stepStart = 0;     // millis() when the step got going
+static unsigned int stepDurationMs = 0;
+static bool stepStarted = false;        // Wheels running as the step asked
+static byte clearingSteps = 0;          // Checks made in this clearing turn
+static bool uTurnInProgress = false;    // Show the completion colour when done
+static NavMode navMode = NAV_MODE_BOUNCE;
+
+// Boustrophedon coverage state
+static float laneHeading = 0;            // Pose heading of the current lane
+static bool turnLeftAtLaneEnd = true;    // Alternates every lane
+static byte laneTransition = LANE_NONE;  // What to do when the plan ends
+static bool shiftBlocked = false;        // Shift between lanes hit an obstacle
+static long laneSideReference = -1;      // Swept-side wall distance, -1 = none
+static bool laneNeedsReference = true;
+static unsigned long laneStartTime = 0;
+static byte shortLanes = 0;              // Lanes in a row that ended at once
+
+// Cleaning rate since the run started (for comparing modes)
+static unsigned long runStartTime = 0;
+static unsigned int runStartCells = 0;
+
+// Apply the motor command for a state as it is entered; moves are timed from
+// the calibrated drive and turn rates. The step's time only starts once the
+// wheels have ramped down and flipped to the new direction (see stepDone())
+static void enterState(NavState state, unsigned int amount) {
+  unsigned int durationMs = amount;
+  navState = state;
+
+  switch (state) {
+    case NAV_FORWARD:
+      break;  // Forward motion is decided on each tick
+    case NAV_TURNING_LEFT:
+      durationMs = rotateBy(amount);
+      break;
+    case NAV_TURNING_RIGHT:
+    case NAV_U_TURN:
+      durationMs = rotateBy(-(float)amount);
+      break;
+    case NAV_CLEARING_LEFT:
+      turnLeft();  // Turns until a sensor clears, checked every amount ms
+      break;
+    case NAV_CLEARING_RIGHT:
+      turnRight();
+      break;
+    case NAV_BACKING_UP:
+      durationMs = driveFor(-(float)amount);
+      break;
+    case NAV_DRIVING:
+      durationMs = driveFor(amount);
+      break;
+    case NAV_PAUSED:
+    case NAV_SETTLING:
+      stopMotors();
+      break;
   }
-  // Check if right side is clear (both right and front-right)
-  else if (rightDistance > obstacleThreshold &&
-           frontRightDistance > obstacleThreshold) {
-    // TURNING RIGHT
-    turnRight();
-    delay(300);
-    stopMotors();
-    return;
+  stepDurationMs = durationMs;
+  stepStarted = false;
+}
+
+// Whether the current step has run its time, counted from when the wheels
+// started doing what it asked
+static bool stepDone() {
+  if (!stepStarted) {
+    if (!driveStarted()) return false;
+    stepStarted = true;
+    stepStart = halMillis();
+  }
+  return halMillis() - stepStart >= stepDurationMs;
+}
+
+// Start a sequence of timed steps
+static void startPlan(const NavStep *steps, byte count) {
+  for (byte i = 0; i < count; i++) {
+    plan[i] = steps[i];
   }
-  // If front-left is clearer than front-right, turn left
-  else if (frontLeftDistance > frontRightDistance &&
-           frontLeftDistance > obstacleThreshold) {
-    // TURNING LEFT
-    turnLeft();
-    delay(300);
-    stopMotors();
+  planLength = count;
+  planIndex = 0;
+  enterState(plan[0].state, plan[0].amount);
+}
+
+// Single step
+static void startStep(NavState state, unsigned int amount) {
+  NavStep step = {state, amount};
+  startPlan(&step, 1);
+}
+
+// Turn until the blocked front corner clears (bounded by MAX_CLEARING_STEPS)
+static void startClearing(NavState state) {
+  clearingSteps = 0;
+  planLength = 0;
+  enterState(state, CLEARING_STEP_MS);
+}
+
+// Back up, then turn around - used when every way forward is blocked
+static void startUTurn() {
+  static const NavStep uTurn[] = {
+      {NAV_BACKING_UP, 10},  // Back up first to create turning space
+      {NAV_PAUSED, 200},
+      {NAV_U_TURN, 180},
+      {NAV_PAUSED, 300}      // Brief pause after turn
+  };
+  startPlan(uTurn, 4);
+  uTurnInProgress = true;
+  setRGBColor(255, 0, 255);  // MAGENTA - 180 turn in progress
+}
+
+// Decision tables: obstacle mask -> manoeuvre, built at compile time
+static constexpr byte driveTable[MASK_COUNT] PROGMEM = {
+    MASK_ROWS(driveManoeuvre)};
+static constexpr byte avoidTable[MASK_COUNT] PROGMEM = {
+    MASK_ROWS(avoidManoeuvre)};
+
+// Tie-break hook for the manoeuvres that compare distances:
+// > 0 prefers left, < 0 prefers right, 0 is a dead heat
+static long clearerSide() {
+  return sensorClearance(readSensor(SENSOR_FRONT_LEFT)) -
+         sensorClearance(readSensor(SENSOR_FRONT_RIGHT));
+}
+
+// Start the manoeuvre picked from a decision table
+static void executeManoeuvre(byte manoeuvre) {
+  switch (manoeuvre) {
+    case MANOEUVRE_FORWARD:
+      // ALL front sensors clear and no side collisions - safe to move forward
+      halDigitalWrite(ledPin, LOW);
+      setRGBColor(0, 255, 0);  // GREEN - Path clear
+      // updateLCD("FORWARD", getSensorSnapshot());
+      moveForward();
+      return;
+
+    // Side collisions - turn away briefly to avoid over-turning
+    case MANOEUVRE_NUDGE_LEFT:
+      halDigitalWrite(ledPin, HIGH);
+      setRGBColor(255, 255, 0);  // YELLOW - Side collision
+      startStep(NAV_TURNING_LEFT, 7);
+      return;
+    case MANOEUVRE_NUDGE_RIGHT:
+      halDigitalWrite(ledPin, HIGH);
+      setRGBColor(255, 255, 0);  // YELLOW - Side collision
+      startStep(NAV_TURNING_RIGHT, 7);
+      return;
+    case MANOEUVRE_BACK_UP:
+      halDigitalWrite(ledPin, HIGH);
+      setRGBColor(255, 0, 255);  // MAGENTA - Both sides collision
+      startStep(NAV_BACKING_UP, 6);
+      return;
+
+    // Avoidance after settling (LED is left as it was)
+    case MANOEUVRE_AVOID_LEFT:
+      startStep(NAV_TURNING_LEFT, 22);
+      return;
+    case MANOEUVRE_AVOID_RIGHT:
+      startStep(NAV_TURNING_RIGHT, 22);
+      return;
+    case MANOEUVRE_AVOID_TOWARD_CLEARER: {
+      long preference = clearerSide();
+      if (preference != 0) {
+        startStep(preference > 0 ? NAV_TURNING_LEFT : NAV_TURNING_RIGHT, 22);
+        return;
+      }
+      executeManoeuvre(MANOEUVRE_BACK_UP_AND_TURN);  // Dead heat - turn around
+      return;
+    }
+    case MANOEUVRE_BACK_UP_AND_TURN: {
+      static const NavStep backAndTurn[] = {
+          {NAV_BACKING_UP, 6}, {NAV_PAUSED, 300}, {NAV_U_TURN, 108}};
+      startPlan(backAndTurn, 3);
+      return;
+    }
+  }
+
+  // Everything else is a front obstacle
+  halDigitalWrite(ledPin, HIGH);
+  setRGBColor(255, 0, 0);  // RED - Obstacle detected
+
+  switch (manoeuvre) {
+    case MANOEUVRE_TURN_LEFT:
+      startStep(NAV_TURNING_LEFT, 14);  // Longer turn to clear both obstacles
+      break;
+    case MANOEUVRE_TURN_RIGHT:
+      startStep(NAV_TURNING_RIGHT, 14);  // Longer turn to clear both obstacles
+      break;
+    case MANOEUVRE_U_TURN:
+      startUTurn();  // DEAD END! Turn 180 degrees
+      break;
+    case MANOEUVRE_TOWARD_CLEARER:
+      startStep(clearerSide() > 0 ? NAV_TURNING_LEFT : NAV_TURNING_RIGHT, 11);
+      break;
+    case MANOEUVRE_CLEAR_LEFT:
+      startClearing(NAV_CLEARING_LEFT);
+      break;
+    case MANOEUVRE_CLEAR_RIGHT:
+      startClearing(NAV_CLEARING_RIGHT);
+      break;
+    case MANOEUVRE_BACK_UP_AND_PAUSE: {
+      static const NavStep backUp[] = {{NAV_BACKING_UP, 4},
+                                       {NAV_PAUSED, 150}};
+      startPlan(backUp, 2);
+      break;
+    }
+  }
+}
+
+// Obstacle avoidance decision from a full five-sensor look (after settling)
+static void decideAvoidance() {
+  updateLCD("OBSTACLE!", getSensorSnapshot());
+
+  byte mask = 0;
+  if (sensorObstacle(SENSOR_LEFT)) mask |= MASK_LEFT;
+  if (sensorObstacle(SENSOR_FRONT_LEFT)) mask |= MASK_FRONT_LEFT;
+  if (sensorObstacle(SENSOR_FRONT)) mask |= MASK_FRONT;
+  if (sensorObstacle(SENSOR_FRONT_RIGHT)) mask |= MASK_FRONT_RIGHT;
+  if (sensorObstacle(SENSOR_RIGHT)) mask |= MASK_RIGHT;
+
+  executeManoeuvre(pgm_read_byte(&avoidTable[mask]));
+}
+
+// Pick the next manoeuvre from this cycle's sensor readings
+static void decideFromSensors() {
+  // Readings come from this cycle's sensor cache - nothing waits on an echo.
+  // Front bits are obstacles, side bits are collisions (very close or touching)
+  byte mask = 0;
+  if (sensorClearance(readSensor(SENSOR_LEFT)) <= 5) mask |= MASK_LEFT;
+  if (sensorObstacle(SENSOR_FRONT_LEFT)) mask |= MASK_FRONT_LEFT;
+  if (getFrontIRObstacle()) mask |= MASK_FRONT;
+  if (sensorObstacle(SENSOR_FRONT_RIGHT)) mask |= MASK_FRONT_RIGHT;
+  if (sensorClearance(readSensor(SENSOR_RIGHT)) <= 5) mask |= MASK_RIGHT;
+
+  executeManoeuvre(pgm_read_byte(&driveTable[mask]));
+}
+
+// Begin a coverage lane. A fresh lane runs along the current heading; the
+// next lane after a lane change runs back the other way
+static void startLane(bool freshLane) {
+  if (freshLane) {
+    laneHeading = getPose().heading;
+  } else {
+    laneHeading += 180;
+    if (laneHeading > 180) laneHeading -= 360;
+
+    // A blocked shift means this side is done - sweep back the other way
+    if (!shiftBlocked) turnLeftAtLaneEnd = !turnLeftAtLaneEnd;
+  }
+  laneTransition = LANE_NONE;
+  laneNeedsReference = true;
+  laneSideReference = -1;
+  laneStartTime = halMillis();
+}
+
+// Move on to the next step of the plan, or back to driving when it is done
+static void advancePlan() {
+  NavState finished = navState;
+
+  planIndex++;
+  if (planIndex < planLength) {
+    enterState(plan[planIndex].state, plan[planIndex].amount);
     return;
   }
-  // If front-right is clearer than front-left, turn right
-  else if (frontRightDistance > frontLeftDistance &&
-           frontRightDistance > obstacleThreshold) {
-    // TURNING RIGHT
-    turnRight();
-    delay(300);
-    stopMotors();
+
+  planLength = 0;
+  if (finished == NAV_SETTLING) {
+    decideAvoidance();
     return;
+  }
+
+  stopMotors();
+  if (uTurnInProgress) {
+    uTurnInProgress = false;
+    showSystemState();  // Turn complete - return to normal system state
+  }
+  if (laneTransition != LANE_NONE) {
+    startLane(laneTransition == LANE_RESTART);
+  }
+  navState = NAV_FORWARD;
+}
+
+// One check of a clearing turn: keep turning, finish, or give up
+static void updateClearing() {
+  bool stillBlocked = navState == NAV_CLEARING_RIGHT
+                          ? sensorObstacle(SENSOR_FRONT_LEFT)
+                          : sensorObstacle(SENSOR_FRONT_RIGHT);
+
+  if (!stillBlocked) {
+    // Corner is now clear, turn a bit more to avoid side collision
+    startStep(navState == NAV_CLEARING_RIGHT ? NAV_TURNING_RIGHT
+                                             : NAV_TURNING_LEFT,
+              11);
+  } else if (++clearingSteps >= MAX_CLEARING_STEPS) {
+    // Never cleared - stop spinning and turn around instead
+    startUTurn();
   } else {
-    // All sides blocked, move backward and try again
-    // BACKING UP
-    moveBackward();
-    delay(300);
-    stopMotors();
-    delay(300);
-
-    // Try turning around
-    // TURN AROUND
-    turnRight();
-    delay(1500);
-    stopMotors();
+    stepStart = halMillis();
+    stepDurationMs = CLEARING_STEP_MS;
+  }
+}
+
+// Lane ended: turn toward the unswept side, shift one lane width, turn again
+static void startLaneChange() {
+  bool shortLane = halMillis() - laneStartTime < MIN_LANE_MS;
+  shortLanes = shortLane ? shortLanes + 1 : 0;
+
+  if (shortLanes >= MAX_SHORT_LANES) {
+    // Boxed in - back out and turn like bounce mode, then start fresh lanes
+    shortLanes = 0;
+    executeManoeuvre(MANOEUVRE_BACK_UP_AND_TURN);
+    laneTransition = LANE_RESTART;
     return;
   }
+
+  NavState turn = turnLeftAtLaneEnd ? NAV_TURNING_LEFT : NAV_TURNING_RIGHT;
+  NavStep laneChange[] = {{NAV_PAUSED, 150},
+                          {turn, 90},
+                          {NAV_DRIVING, (unsigned int)laneWidthCm},
+                          {turn, 90}};
+  startPlan(laneChange, 4);
+  laneTransition = LANE_NEXT;
+  shiftBlocked = false;
 }
 
-// Autonomous navigation logic (extracted from main loop)
-void autonomousNavigation() {
-  static long leftDistance = 0;
-  static long rightDistance = 0;
-  static long frontDistance = 0;
-  static long frontLeftDistance = 0;
-  static long frontRightDistance = 0;
-  
-  // Read all front sensors continuously for complete front awareness
-  bool frontObstacle = getFrontIRObstacle();  // Ultrasonic sensor for front detection
-  frontDistance = getFrontDistance();  // Get actual distance for display
-
-  // Always check front-left and front-right ultrasonic sensors
-  frontLeftDistance = getDistance(frontLeftTrigPin, frontLeftEchoPin);
-  delay(20);
-  frontRightDistance = getDistance(frontRightTrigPin, frontRightEchoPin);
-  delay(20);
-
-  // Determine front obstacle status
-  bool frontLeftObstacle = frontLeftDistance < obstacleThreshold;
-  bool frontRightObstacle = frontRightDistance < obstacleThreshold;
-
-  // Check if ALL three front sensors are clear
-  bool allFrontClear = !frontObstacle && !frontLeftObstacle && !frontRightObstacle;
-
-  // Occasionally check side sensors for awareness (every 5 loops)
-  static int sensorCheckCounter = 0;
-  sensorCheckCounter++;
-
-  if (sensorCheckCounter >= 5) {
-    leftDistance = getDistance(leftTrigPin, leftEchoPin);
-    delay(20);
-    rightDistance = getDistance(rightTrigPin, rightEchoPin);
-    delay(20);
-    sensorCheckCounter = 0;
-  }
-
-  if (allFrontClear) {
-    // Check for side sensor collisions (distance = 0 means very close/touching)
-    bool leftCollision = (leftDistance <= 5);  // Very close or touching on left
-    bool rightCollision = (rightDistance <= 5);  // Very close or touching on right
-
-    if (leftCollision && !rightCollision) {
-      // Left side collision - turn RIGHT to move away
-      digitalWrite(ledPin, HIGH);
-      setRGBColor(255, 255, 0);  // YELLOW - Side collision
-      // updateLCD("LEFT COLLISION", leftDistance, rightDistance, frontDistance,
-      //           frontLeftDistance, frontRightDistance);
-      stopMotors();
-      turnRight();
-      delay(100);  // Reduced rotation to avoid over-turning
-      stopMotors();
-    } else if (rightCollision && !leftCollision) {
-      // Right side collision - turn LEFT to move away
-      digitalWrite(ledPin, HIGH);
-      setRGBColor(255, 255, 0);  // YELLOW - Side collision
-      // updateLCD("RIGHT COLLISION", leftDistance, rightDistance, frontDistance,
-      //           frontLeftDistance, frontRightDistance);
-      stopMotors();
-      turnLeft();
-      delay(100);  // Reduced rotation to avoid over-turning
-      stopMotors();
-    } else if (leftCollision && rightCollision) {
-      // Both sides collision - back up
-      digitalWrite(ledPin, HIGH);
-      setRGBColor(255, 0, 255);  // MAGENTA - Both sides collision
-      // updateLCD("BOTH COLLISION", leftDistance, rightDistance, frontDistance,
-      //           frontLeftDistance, frontRightDistance);
-      stopMotors();
-      moveBackward();
-      delay(300);
-      stopMotors();
-    } else {
-      // ALL front sensors clear and no side collisions - safe to move forward
-      digitalWrite(ledPin, LOW);
-      setRGBColor(0, 255, 0);  // GREEN - Path clear
+// Coverage tick: drive the lane, hold spacing, change lanes at obstacles
+static void decideCoverage() {
+  // Any front obstacle ends the lane
+  if (getFrontIRObstacle() || sensorObstacle(SENSOR_FRONT_LEFT) ||
+      sensorObstacle(SENSOR_FRONT_RIGHT)) {
+    halDigitalWrite(ledPin, HIGH);
+    setRGBColor(255, 0, 0);  // RED - Obstacle detected
+    startLaneChange();
+    return;
+  }
 
-      // updateLCD("FORWARD", leftDistance, rightDistance, frontDistance,
-      //           frontLeftDistance, frontRightDistance);
+  // Side collisions use the same nudges as bounce mode
+  byte mask = 0;
+  if (sensorClearance(readSensor(SENSOR_LEFT)) <= 5) mask |= MASK_LEFT;
+  if (sensorClearance(readSensor(SENSOR_RIGHT)) <= 5) mask |= MASK_RIGHT;
+  if (mask) {
+    executeManoeuvre(pgm_read_byte(&driveTable[mask]));
+    return;
+  }
 
-      moveForward();
+  // The previous lane (or the starting wall) is on the swept side
+  bool sweptOnRight = turnLeftAtLaneEnd;
+  const SensorReading &side =
+      readSensor(sweptOnRight ? SENSOR_RIGHT : SENSOR_LEFT);
+  bool wallSeen = side.valid && side.distance <= LANE_WALL_MAX_CM;
+
+  if (laneNeedsReference) {
+    laneSideReference = wallSeen ? side.distance : -1;
+    laneNeedsReference = false;
+  }
+
+  if (laneSideReference > 0 && wallSeen) {
+    // Hold the distance to the wall we started the lane next to
+    long error = side.distance - laneSideReference;
+    if (error > LANE_SPACING_TOLERANCE_CM) {
+      startStep(sweptOnRight ? NAV_TURNING_RIGHT : NAV_TURNING_LEFT,
+                LANE_NUDGE_DEG);
+      return;
+    }
+    if (error < -LANE_SPACING_TOLERANCE_CM) {
+      startStep(sweptOnRight ? NAV_TURNING_LEFT : NAV_TURNING_RIGHT,
+                LANE_NUDGE_DEG);
+      return;
     }
   } else {
-    // One or more front sensors blocked - determine turning direction
-    digitalWrite(ledPin, HIGH);
-    setRGBColor(255, 0, 0);  // RED - Obstacle detected
+    // No wall to follow - hold the lane heading from dead reckoning
+    float error = getPose().heading - laneHeading;
+    if (error > 180) error -= 360;
+    if (error <= -180) error += 360;
+    if (fabs(error) > LANE_HEADING_TOLERANCE) {
+      startStep(error > 0 ? NAV_TURNING_RIGHT : NAV_TURNING_LEFT,
+                fabs(error));
+      return;
+    }
+  }
+
+  halDigitalWrite(ledPin, LOW);
+  setRGBColor(0, 255, 0);  // GREEN - Path clear
+  moveForward();
+}
+
+// Drop any manoeuvre in progress (e.g. when auto mode is switched on)
+void resetNavigation() {
+  planLength = 0;
+  uTurnInProgress = false;
+  navState = NAV_FORWARD;
+
+  // Coverage starts with a lane along the current heading
+  turnLeftAtLaneEnd = true;
+  shortLanes = 0;
+  startLane(true);
+
+  runStartTime = halMillis();
+  runStartCells = getCleanedCells();
+}
+
+void setNavigationMode(NavMode mode) {
+  navMode = mode;
+  resetNavigation();
+}
+
+NavMode getNavigationMode() {
+  return navMode;
+}
 
-    // Stop first
-    stopMotors();
-
-    // Determine which direction to turn based on which front sensor is blocked
-    if (frontObstacle) {
-      // Front IR blocked - check sides to determine best turn direction
-      if (frontLeftObstacle && !frontRightObstacle) {
-        // Front and front-left blocked, front-right clear - turn RIGHT
-        // updateLCD("TURN RIGHT", leftDistance, rightDistance, frontDistance,
-        //           frontLeftDistance, frontRightDistance);
-        turnRight();
-        delay(200);  // Longer turn to clear both obstacles
-        stopMotors();
-      } else if (frontRightObstacle && !frontLeftObstacle) {
-        // Front and front-right blocked, front-left clear - turn LEFT
-        // updateLCD("TURN LEFT", leftDistance, rightDistance, frontDistance,
-        //           frontLeftDistance, frontRightDistance);
-        turnLeft();
-        delay(200);  // Longer turn to clear both obstacles
-        stopMotors();
-      } else if (frontLeftObstacle && frontRightObstacle) {
-        // All three front sensors blocked - DEAD END! Turn 180 degrees
-        turn180Degrees();
+// Area cleaned per minute (m^2) since the run started
+float getCleaningRate() {
+  float minutes = (halMillis() - runStartTime) / 60000.0;
+  if (minutes <= 0) return 0;
+  float cellArea = (GRID_CELL_CM / 100.0) * (GRID_CELL_CM / 100.0);
+  return (getCleanedCells() - runStartCells) * cellArea / minutes;
+}
+
+// Obstacle avoidance: stop, let every sensor take a fresh reading, then pick
+// the clearest way out
+void avoidObstacle() {
+  startStep(NAV_SETTLING, 500);
+}
+
+// Autonomous navigation logic - one state machine tick per loop()
+void autonomousNavigation() {
+  switch (navState) {
+    case NAV_FORWARD:
+      if (navMode == NAV_MODE_COVERAGE) {
+        decideCoverage();
       } else {
-        // Only front IR blocked, sides clear - turn toward clearer side
-        if (frontLeftDistance > frontRightDistance) {
-          // updateLCD("TURN LEFT", leftDistance, rightDistance, frontDistance,
-          //           frontLeftDistance, frontRightDistance);
-          turnLeft();
-          delay(150);
-        } else {
-          // updateLCD("TURN RIGHT", leftDistance, rightDistance, frontDistance,
-          //           frontLeftDistance, frontRightDistance);
-          turnRight();
-          delay(150);
-        }
+        decideFromSensors();
       }
-    } else if (frontLeftObstacle && !frontRightObstacle) {
-      // Only front-left blocked - turn RIGHT to move away from obstacle
-      // updateLCD("TURN RIGHT", leftDistance, rightDistance, frontDistance,
-                // frontLeftDistance, frontRightDistance);
-
-      // Turn until front-left is clear, then turn a bit more
-      do {
-        turnRight();
-        delay(100);
-        frontLeftDistance = getDistance(frontLeftTrigPin, frontLeftEchoPin);
-        delay(20);
-        frontLeftObstacle = frontLeftDistance < obstacleThreshold;
-      } while (frontLeftObstacle);
-
-      // Front-left is now clear, turn a bit more to avoid side collision
-      turnRight();
-      delay(150);  // Extra turn time
-      stopMotors();
-    } else if (frontRightObstacle && !frontLeftObstacle) {
-      // Only front-right blocked - turn LEFT to move away from obstacle
-      // updateLCD("TURN LEFT", leftDistance, rightDistance, frontDistance,
-      //           frontLeftDistance, frontRightDistance);
-
-      // Turn until front-right is clear, then turn a bit more
-      do {
-        turnLeft();
-        delay(100);
-        frontRightDistance = getDistance(frontRightTrigPin, frontRightEchoPin);
-        delay(20);
-        frontRightObstacle = frontRightDistance < obstacleThreshold;
-      } while (frontRightObstacle);
-
-      // Front-right is now clear, turn a bit more to avoid side collision
-      turnLeft();
-      delay(150);  // Extra turn time
-      stopMotors();
-    } else {
-      // Both front-left and front-right blocked but front IR clear
-      // updateLCD("BACK UP", leftDistance, rightDistance, frontDistance,
-      //           frontLeftDistance, frontRightDistance);
-      moveBackward();
-      delay(200);
-      stopMotors();
-      delay(150);
-    }
-
-    stopMotors();
+      break;
+    case NAV_DRIVING:
+      if (getFrontIRObstacle()) {
+        shiftBlocked = true;
+        advancePlan();
+      } else if (stepDone()) {
+        advancePlan();
+      }
+      break;
+    case NAV_CLEARING_LEFT:
+    case NAV_CLEARING_RIGHT:
+      if (stepDone()) updateClearing();
+      break;
+    default:
+      if (stepDone()) advancePlan();
+      break;
   }
 }
+
+NavState getNavigationState() {
+  return navState;
+}
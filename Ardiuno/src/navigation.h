@@ -1,10 +1,50 @@
 #ifndef NAVIGATION_H
 #define NAVIGATION_H
 
-#include <Arduino.h>
+#include "hal.h"
+
+// Navigation states - timed states end on a millis() deadline
+enum NavState {
+  NAV_FORWARD,         // Driving, re-deciding on every tick
+  NAV_TURNING_LEFT,    // Timed left turn
+  NAV_TURNING_RIGHT,   // Timed right turn
+  NAV_BACKING_UP,      // Timed reverse
+  NAV_PAUSED,          // Motors stopped for a timed pause
+  NAV_U_TURN,          // Timed 180-degree right turn
+  NAV_CLEARING_LEFT,   // Turning left until front-right clears
+  NAV_CLEARING_RIGHT,  // Turning right until front-left clears
+  NAV_SETTLING,        // Stopped, waiting for fresh readings before avoiding
+  NAV_DRIVING          // Timed forward move, cut short by a front obstacle
+};
+
+// Autonomous strategies
+enum NavMode {
+  NAV_MODE_BOUNCE,   // Drive until blocked, then turn away
+  NAV_MODE_COVERAGE  // Boustrophedon: parallel lanes, shift over and reverse
+};
+
+// Clearing turns are re-checked this often, and give up after this many checks
+#define CLEARING_STEP_MS 100
+#define MAX_CLEARING_STEPS 20
+
+// Coverage lanes
+#define LANE_WALL_MAX_CM 60        // Side readings beyond this are not a wall
+#define LANE_SPACING_TOLERANCE_CM 3
+#define LANE_HEADING_TOLERANCE 8   // Degrees of drift before correcting
+#define LANE_NUDGE_DEG 4
+#define MIN_LANE_MS 500            // Shorter lanes count as getting stuck
+#define MAX_SHORT_LANES 3
 
 // Function declarations for autonomous navigation
+void resetNavigation();
 void avoidObstacle();
 void autonomousNavigation();
+NavState getNavigationState();
+void setNavigationMode(NavMode mode);
+NavMode getNavigationMode();
+float getCleaningRate();
+
+// Static RAM of the manoeuvre plan (memory report)
+extern const unsigned int navigationRamBytes;
 
 #endif
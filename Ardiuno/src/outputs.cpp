@@ -0,0 +1,21 @@
+#include "outputs.h"
+
+static OutputStats outputStats = {0, 0};
+
+// Called by every shadowed output (H-bridges, RGB LED) once per request
+void countOutputWrite(bool written) {
+  if (written) {
+    outputStats.written++;
+  } else {
+    outputStats.suppressed++;
+  }
+}
+
+const OutputStats &getOutputStats() {
+  return outputStats;
+}
+
+void resetOutputStats() {
+  outputStats.written = 0;
+  outputStats.suppressed = 0;
+}
@@ -0,0 +1,17 @@
+#ifndef OUTPUTS_H
+#define OUTPUTS_H
+
+#include "hal.h"
+
+// Hardware writes made vs skipped because the output already had that value
+struct OutputStats {
+  unsigned long written;
+  unsigned long suppressed;
+};
+
+// Function declarations for the shadowed output layer
+void countOutputWrite(bool written);
+const OutputStats &getOutputStats();
+void resetOutputStats();
+
+#endif
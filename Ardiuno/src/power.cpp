@@ -0,0 +1,84 @@
+#include "power.h"
+#include "config.h"
+
+static PowerAllocation allocation = {POWER_IDLE, 0, 0, 0, 0, 0, 0};
+
+// Current estimate: full-duty current scaled by the PWM duty cycle
+unsigned int dutyCurrentMa(int pwm, unsigned int fullDutyMa) {
+  return (unsigned long)fullDutyMa * pwm / 255;
+}
+
+static unsigned int stateBudgetMa(PowerState state) {
+  switch (state) {
+    case POWER_DRIVING:
+      return drivingBudgetMa;
+    case POWER_TURNING:
+      return turningBudgetMa;
+    case POWER_REVERSING:
+      return reversingBudgetMa;
+    default:
+      return idleBudgetMa;
+  }
+}
+
+// Trim one cleaning motor to its share of what is left
+static int trim(int pwm, float share) {
+  if (share >= 1) return pwm;
+  int trimmed = pwm * share;
+  return trimmed < POWER_MIN_PWM ? 0 : trimmed;
+}
+
+static unsigned int allocatedMa(const PowerAllocation &a) {
+  return 2 * dutyCurrentMa(a.drive, driveMotorMa) +
+         dutyCurrentMa(a.vacuum, vacuumMotorMa) +
+         dutyCurrentMa(a.mop, mopMotorMa) + dutyCurrentMa(a.pump, pumpMotorMa);
+}
+
+// Share the state's current budget out: the wheels get what they asked for
+// (motion timing is calibrated at that PWM), the cleaning motors are scaled
+// down together to fit in the rest
+const PowerAllocation &allocatePower(PowerState state, int drive, int vacuum,
+                                     int mop, int pump) {
+  unsigned int budget = stateBudgetMa(state);
+  unsigned int driveMa = 2 * dutyCurrentMa(drive, driveMotorMa);
+
+  // Only a misconfigured budget leaves nothing for the wheels
+  if (driveMa > budget) {
+    drive = (unsigned long)drive * budget / driveMa;
+    driveMa = budget;
+  }
+
+  unsigned int cleaningMa = dutyCurrentMa(vacuum, vacuumMotorMa) +
+                            dutyCurrentMa(mop, mopMotorMa) +
+                            dutyCurrentMa(pump, pumpMotorMa);
+  float share = 1;
+  if (cleaningMa > budget - driveMa) {
+    share = (float)(budget - driveMa) / cleaningMa;
+  }
+
+  allocation.state = state;
+  allocation.drive = drive;
+  allocation.vacuum = trim(vacuum, share);
+  allocation.mop = trim(mop, share);
+  allocation.pump = trim(pump, share);
+  allocation.totalMa = allocatedMa(allocation);
+  allocation.budgetMa = budget;
+  return allocation;
+}
+
+const PowerAllocation &getPowerAllocation() {
+  return allocation;
+}
+
+const char *powerStateName(PowerState state) {
+  switch (state) {
+    case POWER_DRIVING:
+      return "driving";
+    case POWER_TURNING:
+      return "turning";
+    case POWER_REVERSING:
+      return "reversing";
+    default:
+      return "idle";
+  }
+}
@@ -0,0 +1,31 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "hal.h"
+
+// Cleaning motors trimmed below this PWM would only stall, so they are
+// switched off instead
+#define POWER_MIN_PWM 40
+
+// What the drive wheels are doing - each has its own current budget
+enum PowerState { POWER_IDLE, POWER_DRIVING, POWER_TURNING, POWER_REVERSING };
+
+// PWM granted to each channel and the estimated current it adds up to
+struct PowerAllocation {
+  PowerState state;
+  int drive;  // Per wheel
+  int vacuum;
+  int mop;
+  int pump;
+  unsigned int totalMa;
+  unsigned int budgetMa;
+};
+
+// Function declarations for the power budget manager
+unsigned int dutyCurrentMa(int pwm, unsigned int fullDutyMa);
+const PowerAllocation &allocatePower(PowerState state, int drive, int vacuum,
+                                     int mop, int pump);
+const PowerAllocation &getPowerAllocation();
+const char *powerStateName(PowerState state);
+
+#endif
@@ -0,0 +1,164 @@
+#include "protocol.h"
+#include "communication.h"
+#include "config.h"
+#include "log.h"
+#include "memory.h"
+#include "motion.h"
+#include "navigation.h"
+#include "rgb_led.h"
+#include "telemetry.h"
+
+// CRC-8, polynomial 0x07, initial value 0
+byte crc8(const byte *data, byte length) {
+  byte crc = 0;
+  for (byte i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (byte bit = 0; bit < 8; bit++) {
+      crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+// Write one frame to Serial3 (value is at most BINARY_MAX_VALUE bytes)
+void sendBinaryFrame(byte sequence, byte opcode, const byte *value,
+                     byte length) {
+  byte frame[BINARY_HEADER_LENGTH + BINARY_MAX_VALUE + 1];
+  frame[0] = BINARY_FRAME_MAGIC;
+  frame[1] = sequence;
+  frame[2] = opcode;
+  frame[3] = length;
+  for (byte i = 0; i < length; i++) {
+    frame[BINARY_HEADER_LENGTH + i] = value[i];
+  }
+  byte crcAt = BINARY_HEADER_LENGTH + length;
+  frame[crcAt] = crc8(frame + 1, crcAt - 1);
+  halUartWrite(HAL_UART_BLE, frame, crcAt + 1);
+}
+
+// Reply with a status code and optional data, echoing the sequence number
+static void sendBinaryResponse(byte sequence, byte opcode, byte status,
+                               const byte *data = NULL, byte dataLength = 0) {
+  byte value[BINARY_MAX_VALUE];
+  value[0] = status;
+  for (byte i = 0; i < dataLength; i++) {
+    value[1 + i] = data[i];
+  }
+  sendBinaryFrame(sequence, opcode | BINARY_RESPONSE_FLAG, value,
+                  1 + dataLength);
+}
+
+byte componentStates() {
+  return (vacuumEnabled ? COMPONENT_VACUUM : 0) |
+         (mopEnabled ? COMPONENT_MOP : 0) | (pumpEnabled ? COMPONENT_PUMP : 0);
+}
+
+byte binaryMode() {
+  if (!autoMode) return MODE_MANUAL;
+  return getNavigationMode() == NAV_MODE_COVERAGE ? MODE_COVERAGE
+                                                  : MODE_BOUNCE;
+}
+
+// Switch the components selected by mask to the matching bit of states
+static void applyComponents(byte mask, byte states) {
+  for (byte component = COMPONENT_VACUUM; component <= COMPONENT_PUMP;
+       component <<= 1) {
+    if (mask & component) setCleaningMotor(component, states & component);
+  }
+  showSystemState();
+}
+
+static byte handleMove(const byte *value, byte length) {
+  static const char directions[] = "sfblr";  // Indexed by BinaryDirection
+  if ((length != 1 && length != 3) || value[0] > DIR_RIGHT) {
+    return STATUS_BAD_LENGTH;
+  }
+  if (!handleMoveCommand(directions[value[0]])) return STATUS_REJECTED;
+
+  if (length == 3) applyComponents(value[1], value[2]);
+  return STATUS_OK;
+}
+
+static byte handleMode(const byte *value, byte length) {
+  static const char modes[] = "mac";  // Indexed by BinaryMode
+  if (length != 1 || value[0] > MODE_COVERAGE) return STATUS_BAD_LENGTH;
+
+  setRobotMode(modes[value[0]]);
+  showSystemState();
+  return STATUS_OK;
+}
+
+// Check and run one binary frame (magic included)
+void processBinaryCommand(const byte *frame, byte length) {
+  byte sequence = frame[1];
+  byte opcode = frame[2];
+  byte valueLength = frame[3];
+  const byte *value = frame + BINARY_HEADER_LENGTH;
+
+  if (length != BINARY_HEADER_LENGTH + valueLength + 1) {
+    sendBinaryResponse(sequence, opcode, STATUS_BAD_LENGTH);
+    return;
+  }
+  if (crc8(frame + 1, length - 2) != frame[length - 1]) {
+    LOG_ERROR(MSG_BAD_CRC);
+    sendBinaryResponse(sequence, opcode, STATUS_BAD_CRC);
+    return;
+  }
+
+  byte status;
+  switch (opcode) {
+    case OP_MOVE:
+      status = handleMove(value, valueLength);
+      break;
+    case OP_COMPONENTS:
+      if (valueLength != 2) {
+        status = STATUS_BAD_LENGTH;
+        break;
+      }
+      applyComponents(value[0], value[1]);
+      status = STATUS_OK;
+      break;
+    case OP_MODE:
+      status = handleMode(value, valueLength);
+      break;
+    case OP_STATUS: {
+      byte data[] = {binaryMode(), componentStates()};
+      sendBinaryResponse(sequence, opcode, STATUS_OK, data, sizeof(data));
+      return;
+    }
+    case OP_EMERGENCY:
+      emergencyStop();
+      status = STATUS_OK;
+      sendBinaryResponse(sequence, opcode, status);  // Before the LED flash
+      showErrorState();
+      return;
+    case OP_CALIBRATE:
+      status = startTurnCalibration() ? STATUS_OK : STATUS_REJECTED;
+      break;
+    case OP_TELEMETRY:
+      if (valueLength != 1) {
+        status = STATUS_BAD_LENGTH;
+        break;
+      }
+      status = setTelemetryRate(value[0]) ? STATUS_OK : STATUS_REJECTED;
+      break;
+    case OP_MEMORY: {
+      updateStackHighWater();
+      const MemoryStats &memory = getMemoryStats();
+      unsigned int counts[] = {memory.dataBytes + memory.bssBytes,
+                               memory.stackPeak, memory.freeLowest,
+                               memory.heapUsed};
+      byte data[2 * sizeof(counts) / sizeof(counts[0])];
+      for (byte i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        data[2 * i] = counts[i] & 0xFF;
+        data[2 * i + 1] = counts[i] >> 8;
+      }
+      sendBinaryResponse(sequence, opcode, STATUS_OK, data, sizeof(data));
+      return;
+    }
+    default:
+      status = STATUS_UNKNOWN_OPCODE;
+      break;
+  }
+  sendBinaryResponse(sequence, opcode, status);
+}
@@ -0,0 +1,53 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "hal.h"
+
+// Compact binary command frame (fits one 20-byte HM-10 packet):
+//   magic, sequence, opcode, length, value[length], CRC-8
+// The CRC covers sequence through the last value byte. Responses use the
+// same layout with the opcode's top bit set and a status code as value[0]
+#define BINARY_FRAME_MAGIC 0xB5
+#define BINARY_HEADER_LENGTH 4
+#define BINARY_MAX_VALUE 15
+#define BINARY_RESPONSE_FLAG 0x80
+
+enum BinaryOpcode {
+  OP_MOVE = 0x01,        // value: direction [, component mask, states]
+  OP_COMPONENTS = 0x02,  // value: component mask, states
+  OP_MODE = 0x03,        // value: BinaryMode
+  OP_STATUS = 0x04,      // reply value: status, mode, component states
+  OP_EMERGENCY = 0x05,
+  OP_CALIBRATE = 0x06,
+  OP_TELEMETRY = 0x07,  // value: telemetry frames per second, 0 = off
+  OP_MEMORY = 0x08      // reply value: status, then 16-bit LE byte counts:
+                        // static RAM, stack peak, lowest free, heap in use
+};
+
+enum BinaryStatus {
+  STATUS_OK,
+  STATUS_BAD_CRC,
+  STATUS_BAD_LENGTH,
+  STATUS_UNKNOWN_OPCODE,
+  STATUS_REJECTED  // Valid, but not allowed right now (e.g. moving in auto)
+};
+
+enum BinaryDirection {
+  DIR_STOP,
+  DIR_FORWARD,
+  DIR_BACKWARD,
+  DIR_LEFT,
+  DIR_RIGHT
+};
+
+enum BinaryMode { MODE_MANUAL, MODE_BOUNCE, MODE_COVERAGE };
+
+// Function declarations for the binary protocol
+byte crc8(const byte *data, byte length);
+void sendBinaryFrame(byte sequence, byte opcode, const byte *value,
+                     byte length);
+void processBinaryCommand(const byte *frame, byte length);
+byte componentStates();
+byte binaryMode();
+
+#endif
@@ -0,0 +1,140 @@
+#include "reassembly.h"
+#include "config.h"
+#include "log.h"
+
+static_assert(CHUNK_MAX_COUNT <= 16, "Chunk bitmap is 16 bits wide");
+
+// One message being put back together. Chunks land straight in their slot
+// of the fixed buffer and are ticked off in the bitmap
+struct ChunkBuffer {
+  char data[CHUNK_MAX_COUNT * CHUNK_DATA_SIZE + 1];
+  byte messageId;
+  byte lastChunk;      // Index of the final chunk
+  byte lastLength;     // Data bytes in the final chunk
+  uint16_t received;   // Bit per chunk that has arrived
+  byte nacksSent;      // Since the last new chunk
+  bool isActive;
+  unsigned long lastChunkTime;
+};
+
+static ChunkBuffer chunkBuffer;
+const unsigned int reassemblyRamBytes = sizeof(ChunkBuffer);
+static int completedId = -1;  // Last delivered message, for duplicate chunks
+
+static uint16_t allChunks() {
+  return (uint16_t)(((uint32_t)1 << (chunkBuffer.lastChunk + 1)) - 1);
+}
+
+static void startMessage(byte messageId, byte lastChunk) {
+  resetChunkBuffer();
+  chunkBuffer.messageId = messageId;
+  chunkBuffer.lastChunk = lastChunk;
+  chunkBuffer.isActive = true;
+}
+
+// Ask the app for every chunk still missing
+static void sendNack() {
+  uint16_t missing = allChunks() & ~chunkBuffer.received;
+  LOG_DEBUG(MSG_CHUNK_NACK, missing);
+
+  halUartPrint(HAL_UART_BLE, "CHUNK_NACK:");
+  halUartPrint(HAL_UART_BLE, chunkBuffer.messageId);
+  const char *separator = ":";
+  for (byte i = 0; i <= chunkBuffer.lastChunk; i++) {
+    if (missing & (1 << i)) {
+      halUartPrint(HAL_UART_BLE, separator);
+      halUartPrint(HAL_UART_BLE, i);
+      separator = ",";
+    }
+  }
+  halUartPrintln(HAL_UART_BLE);
+  chunkBuffer.nacksSent++;
+}
+
+// Take one chunk payload. Returns true when it completed a message, which
+// has then been acknowledged and dispatched
+bool processChunkedData(const byte *data, byte length) {
+  if (length <= CHUNK_HEADER_LENGTH) return false;  // Need at least 1 byte
+
+  byte messageId = data[0];
+  byte chunkNum = data[1];
+  byte lastChunk = data[2];
+  byte dataLength = length - CHUNK_HEADER_LENGTH;
+
+  if (lastChunk >= CHUNK_MAX_COUNT || chunkNum > lastChunk ||
+      dataLength > CHUNK_DATA_SIZE ||
+      (chunkNum < lastChunk && dataLength != CHUNK_DATA_SIZE)) {
+    LOG_ERROR(MSG_BAD_CHUNK, chunkNum, lastChunk + 1, dataLength);
+    return false;
+  }
+
+  // A resend of a message already delivered means our ACK was lost
+  if (!chunkBuffer.isActive && messageId == completedId) {
+    halUartPrint(HAL_UART_BLE, "CHUNK_ACK:");
+    halUartPrintln(HAL_UART_BLE, messageId);
+    return false;
+  }
+
+  // Any other id (or a different length) starts a new message
+  if (!chunkBuffer.isActive || messageId != chunkBuffer.messageId ||
+      lastChunk != chunkBuffer.lastChunk) {
+    if (chunkBuffer.isActive) {
+      LOG_WARN(MSG_CHUNK_ABANDONED, chunkBuffer.messageId, messageId);
+    }
+    startMessage(messageId, lastChunk);
+  }
+
+  uint16_t bit = 1 << chunkNum;
+  if (chunkBuffer.received & bit) return false;  // Duplicate
+
+  LOG_DEBUG(MSG_CHUNK, chunkNum, lastChunk + 1, messageId);
+  memcpy(chunkBuffer.data + chunkNum * CHUNK_DATA_SIZE,
+         data + CHUNK_HEADER_LENGTH, dataLength);
+  if (chunkNum == lastChunk) chunkBuffer.lastLength = dataLength;
+  chunkBuffer.received |= bit;
+  chunkBuffer.nacksSent = 0;
+  chunkBuffer.lastChunkTime = halMillis();
+
+  if (chunkBuffer.received != allChunks()) {
+    // The final chunk is normally sent last - any gap now is a loss
+    if (chunkNum == lastChunk) sendNack();
+    return false;
+  }
+
+  int messageLength = lastChunk * CHUNK_DATA_SIZE + chunkBuffer.lastLength;
+  chunkBuffer.data[messageLength] = '\0';
+  chunkBuffer.isActive = false;
+  completedId = messageId;
+  halUartPrint(HAL_UART_BLE, "CHUNK_ACK:");
+  halUartPrintln(HAL_UART_BLE, messageId);
+  LOG_DEBUG(MSG_CHUNKED_COMMAND, chunkBuffer.data);
+
+  // Process the complete command (the buffer is free until the next chunk)
+  processBLECommand(chunkBuffer.data);
+  return true;
+}
+
+// Re-request missing chunks while a message stalls, and give up on it after
+// CHUNK_TIMEOUT_MS without a new chunk
+void updateChunkReassembly() {
+  if (!chunkBuffer.isActive) return;
+
+  unsigned long quiet = halMillis() - chunkBuffer.lastChunkTime;
+  if (quiet > CHUNK_TIMEOUT_MS) {
+    LOG_WARN(MSG_CHUNK_TIMEOUT);
+    resetChunkBuffer();
+  } else if (chunkBuffer.nacksSent < CHUNK_MAX_NACKS &&
+             quiet > CHUNK_NACK_GAP_MS * (chunkBuffer.nacksSent + 1UL)) {
+    sendNack();
+  }
+}
+
+void resetChunkBuffer() {
+  chunkBuffer.data[0] = '\0';
+  chunkBuffer.received = 0;
+  chunkBuffer.lastChunk = 0;
+  chunkBuffer.lastLength = 0;
+  chunkBuffer.nacksSent = 0;
+  chunkBuffer.isActive = false;
+  chunkBuffer.lastChunkTime = 0;
+}
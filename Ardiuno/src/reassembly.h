@@ -0,0 +1,30 @@
+#ifndef REASSEMBLY_H
+#define REASSEMBLY_H
+
+#include "hal.h"
+#include "communication.h"
+
+// Chunk payload (after the CHUNK_FRAME_MAGIC/length header, see receiver.h):
+//   message id, chunk index, last chunk index, data
+// Every chunk but the last carries exactly CHUNK_DATA_SIZE data bytes, so a
+// chunk's place in the message follows from its index and chunks can arrive
+// in any order
+#define CHUNK_HEADER_LENGTH 3
+#define CHUNK_DATA_SIZE 15  // Fills one 20-byte HM-10 packet
+#define CHUNK_MAX_COUNT (MAX_COMMAND_LENGTH / CHUNK_DATA_SIZE)
+
+// Missing chunks are requested again ("CHUNK_NACK:<id>:<i>,<j>,...") when the
+// last chunk shows up with gaps, or when nothing has arrived for this long.
+// A complete message is confirmed with "CHUNK_ACK:<id>"
+#define CHUNK_NACK_GAP_MS 150
+#define CHUNK_MAX_NACKS 3  // Without progress, then wait for the timeout
+
+// Function declarations for chunked command reassembly
+bool processChunkedData(const byte *data, byte length);
+void updateChunkReassembly();
+void resetChunkBuffer();
+
+// Static RAM of the chunk buffer (memory report)
+extern const unsigned int reassemblyRamBytes;
+
+#endif
@@ -0,0 +1,140 @@
+#include "receiver.h"
+#include "communication.h"
+#include "log.h"
+#include "protocol.h"
+#include "reassembly.h"
+
+static byte rxBuffer[RX_BUFFER_SIZE];
+static byte rxHead = 0;  // Next byte written
+static byte rxTail = 0;  // Next byte read
+static byte rxScanned = 0;  // Bytes already searched for a newline
+static unsigned long lastByteTime = 0;
+
+// Complete frame handed to the dispatcher
+static char frame[FRAME_MAX_LENGTH + 1];
+const unsigned int receiverRamBytes = sizeof(rxBuffer) + sizeof(frame);
+
+static byte rxCount() {
+  return (rxHead - rxTail) & (RX_BUFFER_SIZE - 1);
+}
+
+static byte rxPeek(byte offset) {
+  return rxBuffer[(rxTail + offset) & (RX_BUFFER_SIZE - 1)];
+}
+
+// Move the first length bytes out of the ring into the frame buffer
+static void rxTake(byte length) {
+  for (byte i = 0; i < length; i++) {
+    frame[i] = rxPeek(i);
+  }
+  frame[length] = '\0';
+  rxTail = (rxTail + length) & (RX_BUFFER_SIZE - 1);
+  rxScanned = 0;
+}
+
+static void rxDrop(byte length) {
+  rxTail = (rxTail + length) & (RX_BUFFER_SIZE - 1);
+  rxScanned = 0;
+}
+
+// Binary chunk frame at the front of the ring. Returns true once handled
+static bool takeChunkFrame(byte available, bool idle) {
+  if (available < 2) {
+    if (idle) rxDrop(available);
+    return false;
+  }
+
+  byte length = rxPeek(1);
+  if (length <= CHUNK_HEADER_LENGTH || length > CHUNK_PAYLOAD_MAX) {
+    LOG_ERROR(MSG_BAD_CHUNK_FRAME, length);
+    rxDrop(1);  // Resynchronise on the next byte
+    return true;
+  }
+
+  if (available < 2 + length) {
+    if (idle) {
+      LOG_WARN(MSG_INCOMPLETE_CHUNK_FRAME);
+      rxDrop(available);
+    }
+    return false;  // Rest of the packet still on its way
+  }
+
+  rxDrop(2);
+  rxTake(length);
+  processChunkedData((const byte *)frame, length);
+  return true;
+}
+
+// Binary command frame at the front of the ring (see protocol.h)
+static bool takeBinaryFrame(byte available, bool idle) {
+  if (available < BINARY_HEADER_LENGTH) {
+    if (idle) rxDrop(available);
+    return false;
+  }
+
+  byte valueLength = rxPeek(3);
+  if (valueLength > BINARY_MAX_VALUE) {
+    LOG_ERROR(MSG_BAD_BINARY_FRAME, valueLength);
+    rxDrop(1);  // Resynchronise on the next byte
+    return true;
+  }
+
+  byte length = BINARY_HEADER_LENGTH + valueLength + 1;
+  if (available < length) {
+    if (idle) {
+      LOG_WARN(MSG_INCOMPLETE_BINARY_FRAME);
+      rxDrop(available);
+    }
+    return false;
+  }
+
+  rxTake(length);
+  processBinaryCommand((const byte *)frame, length);
+  return true;
+}
+
+// Newline-terminated text frame at the front of the ring
+static bool takeTextFrame(byte available, bool idle) {
+  byte length = rxScanned;
+  while (length < available && rxPeek(length) != '\n' &&
+         rxPeek(length) != '\r') {
+    length++;
+  }
+  rxScanned = length;
+
+  bool terminated = length < available;
+  if (!terminated && !idle && available < FRAME_MAX_LENGTH) {
+    return false;  // Rest of the command still on its way
+  }
+
+  rxTake(length);
+  if (terminated) rxDrop(1);
+  if (length == 0) return true;  // Second half of a CRLF
+
+  LOG_DEBUG(MSG_FRAME, frame);
+  processBLECommand(frame);
+  return true;
+}
+
+// Pull whatever Serial3 has into the ring and dispatch at most one complete
+// frame. Never waits for bytes; returns true if a frame was handled
+bool pollBLEReceiver() {
+  while (halUartAvailable(HAL_UART_BLE) &&
+         rxCount() < RX_BUFFER_SIZE - 1) {
+    rxBuffer[rxHead] = halUartRead(HAL_UART_BLE);
+    rxHead = (rxHead + 1) & (RX_BUFFER_SIZE - 1);
+    lastByteTime = halMillis();
+  }
+
+  byte available = rxCount();
+  if (available == 0) return false;
+
+  bool idle = halMillis() - lastByteTime >= FRAME_IDLE_GAP_MS;
+  if (rxPeek(0) == CHUNK_FRAME_MAGIC) {
+    return takeChunkFrame(available, idle);
+  }
+  if (rxPeek(0) == BINARY_FRAME_MAGIC) {
+    return takeBinaryFrame(available, idle);
+  }
+  return takeTextFrame(available, idle);
+}
@@ -0,0 +1,29 @@
+#ifndef RECEIVER_H
+#define RECEIVER_H
+
+#include "hal.h"
+
+// Serial3 receive ring (power of two so the indices can wrap with a mask)
+#define RX_BUFFER_SIZE 128
+#define FRAME_MAX_LENGTH (RX_BUFFER_SIZE - 1)
+
+// Framing on the BLE link:
+//  - text (legacy and JSON) commands end with '\n' (a '\r' is also accepted)
+//  - binary chunks are CHUNK_FRAME_MAGIC, payload length, payload (see
+//    reassembly.h)
+//  - binary commands start with BINARY_FRAME_MAGIC (see protocol.h)
+#define CHUNK_FRAME_MAGIC 0xA5
+#define CHUNK_FRAME_MAX 20  // One HM-10 packet
+#define CHUNK_PAYLOAD_MAX (CHUNK_FRAME_MAX - 2)  // Less magic and length
+
+// Text that stops arriving without a newline is taken as a whole command
+// after this gap (older app builds send no terminator)
+#define FRAME_IDLE_GAP_MS 50
+
+// Function declarations for the BLE receiver
+bool pollBLEReceiver();
+
+// Static RAM of the receive ring and frame buffer (memory report)
+extern const unsigned int receiverRamBytes;
+
+#endif
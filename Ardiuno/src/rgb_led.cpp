@@ -1,13 +1,34 @@
 #include "rgb_led.h"
 #include "config.h"
+#include "outputs.h"
+
+// Idle breathing effect state (see updateRGBLED)
+#define IDLE_BREATH_MS 2100UL
+static bool idleBreathing = false;
+static unsigned long idleBreathStart = 0;
+
+// Last colour written to the LED (-1 = not written yet)
+static int shownRed = -1;
+static int shownGreen = -1;
+static int shownBlue = -1;
+
+// Write one colour channel only if it changed
+static void writeChannel(int pin, int &shown, int value) {
+  bool changed = value != shown;
+  if (changed) {
+    shown = value;
+    halAnalogWrite(pin, value);
+  }
+  countOutputWrite(changed);
+}
 
 // RGB LED Control Functions for HW-478 Module
 void setRGBColor(int red, int green, int blue) {
   // HW-478 is typically Common Cathode, so HIGH = ON
   // Values: 0-255 for PWM control (0 = off, 255 = full brightness)
-  analogWrite(rgbRedPin, red);
-  analogWrite(rgbGreenPin, green);
-  analogWrite(rgbBluePin, blue);
+  writeChannel(rgbRedPin, shownRed, red);
+  writeChannel(rgbGreenPin, shownGreen, green);
+  writeChannel(rgbBluePin, shownBlue, blue);
 }
 
 void rgbOff() { 
@@ -16,14 +37,14 @@ void rgbOff() {
 
 // LED command - Blink green for 2-3 seconds
 void blinkGreenLED() {
-  unsigned long startTime = millis();
+  unsigned long startTime = halMillis();
   unsigned long blinkDuration = 2500;  // 2.5 seconds
 
-  while (millis() - startTime < blinkDuration) {
+  while (halMillis() - startTime < blinkDuration) {
     setRGBColor(0, 255, 0);  // Green ON
-    delay(200);
+    halDelay(200);
     rgbOff();  // Green OFF
-    delay(200);
+    halDelay(200);
   }
 
   // Return to system state after blinking
@@ -32,6 +53,7 @@ void blinkGreenLED() {
 
 // Show different system states with colors
 void showSystemState() {
+  idleBreathing = false;  // Any state change ends the idle effect
   if (autoMode) {
     if (vacuumEnabled || mopEnabled || pumpEnabled) {
       setRGBColor(0, 255, 255);  // CYAN - Auto mode with cleaning active
@@ -52,7 +74,7 @@ void showBatteryState() {
   // Simulate battery levels with different colors
   // Green = Good (80-100%), Yellow = Medium (40-80%), Red = Low (<40%)
   setRGBColor(255, 255, 0);  // YELLOW - Medium battery (example)
-  delay(2000);
+  halDelay(2000);
   showSystemState();  // Return to normal state
 }
 
@@ -60,25 +82,35 @@ void showBatteryState() {
 void showErrorState() {
   for (int i = 0; i < 5; i++) {
     setRGBColor(255, 0, 0);  // RED - Error
-    delay(150);
+    halDelay(150);
     rgbOff();
-    delay(150);
+    halDelay(150);
   }
   showSystemState();  // Return to normal state
 }
 
 // Show idle/waiting state
 void showIdleState() {
-  // Gentle white breathing effect
-  for (int brightness = 0; brightness <= 100; brightness += 5) {
-    setRGBColor(brightness, brightness, brightness);
-    delay(50);
-  }
-  for (int brightness = 100; brightness >= 0; brightness -= 5) {
-    setRGBColor(brightness, brightness, brightness);
-    delay(50);
+  // Gentle white breathing effect, played out by updateRGBLED()
+  idleBreathing = true;
+  idleBreathStart = halMillis();
+}
+
+// Advance non-blocking LED effects (called from the LED task)
+void updateRGBLED() {
+  if (!idleBreathing) return;
+
+  unsigned long elapsed = halMillis() - idleBreathStart;
+  if (elapsed >= IDLE_BREATH_MS) {
+    showSystemState();  // Return to normal state
+    return;
   }
-  showSystemState();  // Return to normal state
+
+  // Ramp 0 -> 100 -> 0
+  unsigned long half = IDLE_BREATH_MS / 2;
+  int brightness = elapsed < half ? elapsed * 100 / half
+                                  : (IDLE_BREATH_MS - elapsed) * 100 / half;
+  setRGBColor(brightness, brightness, brightness);
 }
 
 // Blue pulsing effect
@@ -87,12 +119,12 @@ void pulseBlue() {
     // Fade in
     for (int brightness = 0; brightness <= 255; brightness += 5) {
       setRGBColor(0, 0, brightness);
-      delay(20);
+      halDelay(20);
     }
     // Fade out
     for (int brightness = 255; brightness >= 0; brightness -= 5) {
       setRGBColor(0, 0, brightness);
-      delay(20);
+      halDelay(20);
     }
   }
 
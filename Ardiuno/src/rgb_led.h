@@ -1,7 +1,7 @@
 #ifndef RGB_LED_H
 #define RGB_LED_H
 
-#include <Arduino.h>
+#include "hal.h"
 
 // RGB LED function declarations
 void setRGBColor(int red, int green, int blue);
@@ -15,5 +15,6 @@ void showBatteryState();
 void showErrorState();
 void showIdleState();
 void pulseBlue();
+void updateRGBLED();
 
 #endif
@@ -0,0 +1,72 @@
+#include "scheduler.h"
+#include "log.h"
+
+static Task *taskTable = NULL;
+static byte taskCount = 0;
+static unsigned long maxTickUs = 0;  // Longest pass since takeMaxTickUs()
+
+void initializeScheduler(Task *tasks, byte count) {
+  taskTable = tasks;
+  taskCount = count;
+
+  // Keep the table in priority order so one pass runs due tasks highest first
+  for (byte i = 1; i < taskCount; i++) {
+    Task task = taskTable[i];
+    byte j = i;
+    while (j > 0 && taskTable[j - 1].priority < task.priority) {
+      taskTable[j] = taskTable[j - 1];
+      j--;
+    }
+    taskTable[j] = task;
+  }
+
+  unsigned long now = halMillis();
+  for (byte i = 0; i < taskCount; i++) {
+    taskTable[i].nextRun = now;
+    taskTable[i].overruns = 0;
+    taskTable[i].maxRunUs = 0;
+  }
+}
+
+// One scheduler tick: run every task that is due, in priority order
+void runScheduler() {
+  unsigned long tickStart = halMicros();
+  for (byte i = 0; i < taskCount; i++) {
+    Task &task = taskTable[i];
+    unsigned long now = halMillis();
+
+    if ((long)(now - task.nextRun) < 0) continue;
+
+    unsigned long startTime = halMicros();
+    task.run();
+    unsigned long runTime = halMicros() - startTime;
+
+    if (runTime > task.maxRunUs) task.maxRunUs = runTime;
+    if (runTime > task.budgetUs) task.overruns++;
+
+    // Fixed-rate schedule; if we fell a whole period behind, don't burst
+    task.nextRun += task.periodMs;
+    if ((long)(now - task.nextRun) >= (long)task.periodMs) {
+      task.nextRun = now + task.periodMs;
+    }
+  }
+
+  unsigned long tickUs = halMicros() - tickStart;
+  if (tickUs > maxTickUs) maxTickUs = tickUs;
+}
+
+// Longest scheduler pass since the last call, then start measuring afresh
+unsigned long takeMaxTickUs() {
+  unsigned long longest = maxTickUs;
+  maxTickUs = 0;
+  return longest;
+}
+
+void printSchedulerStats() {
+  reportMessage(MSG_TASKS_BEGIN);
+  for (byte i = 0; i < taskCount; i++) {
+    const Task &task = taskTable[i];
+    reportMessage(MSG_TASK, task.name, task.maxRunUs, task.budgetUs,
+                  task.overruns);
+  }
+}
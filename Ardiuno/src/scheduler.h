@@ -0,0 +1,24 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "hal.h"
+
+// One entry of the static task table
+struct Task {
+  const char *name;
+  void (*run)();
+  unsigned int periodMs;   // 0 = run on every tick
+  byte priority;           // Higher runs first when several tasks are due
+  unsigned int budgetUs;   // Run time above this counts as an overrun
+  unsigned long nextRun;   // millis() when the task is next due
+  unsigned int overruns;   // Runs that went over budget
+  unsigned long maxRunUs;  // Longest run seen
+};
+
+// Function declarations for the cooperative scheduler
+void initializeScheduler(Task *tasks, byte count);
+void runScheduler();
+void printSchedulerStats();
+unsigned long takeMaxTickUs();
+
+#endif
@@ -1,26 +1,301 @@
 #include "sensors.h"
 #include "config.h"
+#include "log.h"
 
-long getDistance(int trigPin, int echoPin) {
-  digitalWrite(trigPin, LOW);
-  delayMicroseconds(2);
-  digitalWrite(trigPin, HIGH);
-  delayMicroseconds(10);
-  digitalWrite(trigPin, LOW);
+// Ranging slot states
+#define PING_IDLE 0  // No ping in flight
+#define PING_SENT 1  // Trigger sent, waiting for echo rising edge
+#define PING_ECHO 2  // Echo high, waiting for falling edge
+#define PING_DONE 3  // Both edges captured, ready to convert
 
-  long duration = pulseIn(echoPin, HIGH);
-  int distance = duration * 0.034 / 2;  // Convert to cm
-  return distance;
+// Per-sensor ranging slot, edges are filled in by the echo pin-change ISR
+struct RangingSlot {
+  volatile unsigned long echoStart;  // micros() at echo rising edge
+  volatile unsigned long echoEnd;    // micros() at echo falling edge
+  volatile byte state;               // PING_* state
+  unsigned long triggerTime;         // micros() when the trigger was sent
+};
+
+// Per-sensor filter: ring buffer of accepted readings feeding a median
+struct SensorFilter {
+  long history[SENSOR_HISTORY];  // Ring buffer of accepted readings in cm
+  byte head;                     // Next slot to write
+  byte count;                    // Readings in the buffer
+  byte outlierStreak;            // Consecutive rejected readings that agree
+  long outlierDistance;          // Latest of those rejected readings
+  long filtered;                 // Median of the buffer
+  unsigned long lastAccepted;    // millis() of the last accepted reading
+};
+
+static RangingSlot slots[SENSOR_COUNT];
+static byte trigPins[SENSOR_COUNT];
+static byte echoMasks[SENSOR_COUNT];  // Bit of each echo pin in the levels
+static volatile byte lastEchoLevels = 0;
+static SensorFilter filters[SENSOR_COUNT];
+static SensorSnapshot snapshot;  // Per-cycle cache, see readSensor()
+static unsigned int sensorEpoch = 1;          // Bumped by beginSensorCycle()
+static unsigned int cachedEpoch[SENSOR_COUNT];  // Epoch each reading was taken in
+
+// Firing scheduler state
+static int sensorAngles[SENSOR_COUNT];
+static unsigned int *const pingRates[SENSOR_COUNT] = {
+    &leftPingRate, &rightPingRate, &frontPingRate, &frontLeftPingRate,
+    &frontRightPingRate};
+static byte crosstalkMasks[SENSOR_COUNT];  // Sensors each one can't fire with
+static unsigned long nextPingDue[SENSOR_COUNT];  // millis() of next ping
+
+const unsigned int sensorsRamBytes =
+    sizeof(slots) + sizeof(filters) + sizeof(snapshot) + sizeof(cachedEpoch) +
+    sizeof(nextPingDue);
+
+// Every edge on any echo pin, from the pin-change interrupt (see hal.h)
+static void echoEdge(byte levels, unsigned long now) {
+  byte changed = levels ^ lastEchoLevels;
+  lastEchoLevels = levels;
+
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    if (!(changed & echoMasks[i])) continue;
+
+    if ((levels & echoMasks[i]) && slots[i].state == PING_SENT) {
+      slots[i].echoStart = now;
+      slots[i].state = PING_ECHO;
+    } else if (!(levels & echoMasks[i]) && slots[i].state == PING_ECHO) {
+      slots[i].echoEnd = now;
+      slots[i].state = PING_DONE;
+    }
+  }
+}
+
+static void registerSensor(SensorId id, int trigPin, int echoPin, int angle) {
+  trigPins[id] = trigPin;
+  sensorAngles[id] = angle;
+  echoMasks[id] = halEchoMask(echoPin);
+
+  halPinMode(trigPin, OUTPUT);
+  halDigitalWrite(trigPin, LOW);
+  halPinMode(echoPin, INPUT);
+
+  if (!echoMasks[id]) {
+    LOG_ERROR(MSG_BAD_ECHO_PIN, echoPin);
+    return;
+  }
+
+  slots[id].state = PING_IDLE;
+  filters[id].head = 0;
+  filters[id].count = 0;
+  filters[id].outlierStreak = 0;
+}
+
+void initializeSensors() {
+  registerSensor(SENSOR_LEFT, leftTrigPin, leftEchoPin, leftSensorAngle);
+  registerSensor(SENSOR_RIGHT, rightTrigPin, rightEchoPin, rightSensorAngle);
+  registerSensor(SENSOR_FRONT, frontTrigPin, frontEchoPin, frontSensorAngle);
+  registerSensor(SENSOR_FRONT_LEFT, frontLeftTrigPin, frontLeftEchoPin,
+                 frontLeftSensorAngle);
+  registerSensor(SENSOR_FRONT_RIGHT, frontRightTrigPin, frontRightEchoPin,
+                 frontRightSensorAngle);
+
+  // Work out which sensors would hear each other's echoes
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    crosstalkMasks[i] = 0;
+    for (byte j = 0; j < SENSOR_COUNT; j++) {
+      if (i != j &&
+          abs(sensorAngles[i] - sensorAngles[j]) < crosstalkMinAngle) {
+        crosstalkMasks[i] |= bit(j);
+      }
+    }
+    nextPingDue[i] = halMillis();
+  }
+
+  byte echoPins = 0;
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    echoPins |= echoMasks[i];
+  }
+  lastEchoLevels = halEchoLevels();
+  halBeginEchoCapture(echoPins, echoEdge);
+}
+
+// Send one 10us trigger pulse to every sensor in the group; the ISR takes it
+// from here
+static void firePingGroup(byte group) {
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    if (group & bit(i)) halDigitalWrite(trigPins[i], HIGH);
+  }
+  halDelayMicroseconds(10);
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    if (group & bit(i)) halDigitalWrite(trigPins[i], LOW);
+  }
+
+  unsigned long now = halMicros();
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    if (group & bit(i)) {
+      slots[i].triggerTime = now;
+      slots[i].state = PING_SENT;
+    }
+  }
+}
+
+// Pick the most overdue sensor, then add every other due sensor that cannot
+// hear it (or anything else already in the group)
+static byte buildPingGroup(unsigned long now) {
+  byte group = 0;
+
+  while (true) {
+    int best = -1;
+    for (byte i = 0; i < SENSOR_COUNT; i++) {
+      if (*pingRates[i] == 0 || (group & bit(i))) continue;
+      if ((long)(now - nextPingDue[i]) < 0) continue;  // Not due yet
+      if (crosstalkMasks[i] & group) continue;
+      if (best < 0 || (long)(nextPingDue[i] - nextPingDue[best]) < 0) best = i;
+    }
+    if (best < 0) break;
+
+    group |= bit(best);
+    unsigned long period = 1000UL / *pingRates[best];
+    nextPingDue[best] += period;
+    if ((long)(now - nextPingDue[best]) > 0) {
+      nextPingDue[best] = now + period;  // Fell behind, don't burst to catch up
+    }
+  }
+
+  return group;
+}
+
+static long medianOf(const SensorFilter &filter) {
+  long sorted[SENSOR_HISTORY];
+  for (byte i = 0; i < filter.count; i++) {
+    // Insertion sort - at most SENSOR_HISTORY entries
+    long value = filter.history[i];
+    byte j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[filter.count / 2];
+}
+
+// Feed one raw reading through outlier rejection and the median filter
+static void filterReading(byte id, long distance) {
+  SensorFilter &filter = filters[id];
+  unsigned long now = halMillis();
+
+  if (distance > SENSOR_MAX_RANGE_CM) distance = SENSOR_MAX_RANGE_CM;
+
+  // Reject readings that moved faster than the robot possibly could
+  if (filter.count > 0) {
+    long elapsed = now - filter.lastAccepted;
+    long allowed = 5 + maxDistanceRate * elapsed / 1000;
+    if (abs(distance - filter.filtered) > allowed) {
+      // Only the same jump repeating counts towards accepting it
+      bool agrees = filter.outlierStreak > 0 &&
+                    abs(distance - filter.outlierDistance) <= OUTLIER_MATCH_CM;
+      filter.outlierStreak = agrees ? filter.outlierStreak + 1 : 1;
+      filter.outlierDistance = distance;
+      if (filter.outlierStreak < MAX_OUTLIER_STREAK) return;
+
+      // The scene really changed - start the median over from the new
+      // distance instead of feeding it in one sample at a time
+      for (byte i = 0; i < SENSOR_HISTORY; i++) {
+        filter.history[i] = distance;
+      }
+      filter.head = 0;
+      filter.count = SENSOR_HISTORY;
+    }
+  }
+  filter.outlierStreak = 0;
+
+  filter.history[filter.head] = distance;
+  filter.head = (filter.head + 1) % SENSOR_HISTORY;
+  if (filter.count < SENSOR_HISTORY) filter.count++;
+
+  filter.filtered = medianOf(filter);
+  filter.lastAccepted = now;
+}
+
+// Collect finished pings and start the next one - never waits on an echo
+void updateRanging() {
+  bool pingInFlight = false;
+
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    halInterruptsOff();
+    byte state = slots[i].state;
+    unsigned long echoStart = slots[i].echoStart;
+    unsigned long echoEnd = slots[i].echoEnd;
+    halInterruptsOn();
+
+    if (state == PING_DONE) {
+      long duration = echoEnd - echoStart;
+      slots[i].state = PING_IDLE;
+      filterReading(i, duration * 0.034 / 2);  // Convert to cm
+    } else if (state != PING_IDLE) {
+      if (halMicros() - slots[i].triggerTime > ECHO_TIMEOUT_US) {
+        slots[i].state = PING_IDLE;
+        // An echo still high is a ping that found nothing in range. One that
+        // never rose is a dead or unplugged sensor: feed nothing, so the
+        // reading goes stale and counts as blocked
+        if (state == PING_ECHO) filterReading(i, SENSOR_MAX_RANGE_CM);
+      } else {
+        pingInFlight = true;
+      }
+    }
+  }
+
+  // Start the next group only once every echo of the last one is in
+  if (!pingInFlight) {
+    byte group = buildPingGroup(halMillis());
+    if (group) firePingGroup(group);
+  }
+}
+
+// Start a new control cycle: everything cached so far is stale
+void beginSensorCycle() {
+  sensorEpoch++;
+}
+
+// Sample a sensor at most once per control cycle; later calls in the same
+// cycle get the cached value
+const SensorReading &readSensor(SensorId id) {
+  SensorReading &reading = snapshot.readings[id];
+
+  if (cachedEpoch[id] != sensorEpoch) {
+    reading.distance = filters[id].filtered;
+    reading.ageMs = halMillis() - filters[id].lastAccepted;
+    reading.valid = filters[id].count > 0 && reading.ageMs <= SENSOR_STALE_MS;
+    cachedEpoch[id] = sensorEpoch;
+  }
+  return reading;
+}
+
+// Filtered view of all five sensors - navigation, LCD and telemetry all read
+// this instead of touching the hardware
+const SensorSnapshot &getSensorSnapshot() {
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    readSensor((SensorId)i);
+  }
+  return snapshot;
+}
+
+// Distance to drive on. A sensor with no recent reading (dead, unplugged or
+// stalled) counts as blocked, never as open space
+long sensorClearance(const SensorReading &reading) {
+  return reading.valid ? reading.distance : 0;
+}
+
+// Threshold check derived from this cycle's cached reading
+bool sensorObstacle(SensorId id) {
+  return sensorClearance(readSensor(id)) < obstacleThreshold;
 }
 
 // Front ultrasonic sensor reading function
 bool getFrontIRObstacle() {
-  long distance = getDistance(frontTrigPin, frontEchoPin);
   // Return true if obstacle is detected (distance less than threshold)
-  return distance < obstacleThreshold;
+  return sensorObstacle(SENSOR_FRONT);
 }
 
 // Get front distance for ultrasonic sensor (for LCD display)
-long getFrontDistance() { 
-  return getDistance(frontTrigPin, frontEchoPin); 
+long getFrontDistance() {
+  const SensorReading &reading = readSensor(SENSOR_FRONT);
+  return reading.valid ? reading.distance : SENSOR_MAX_RANGE_CM;
 }
@@ -1,11 +1,52 @@
 #ifndef SENSORS_H
 #define SENSORS_H
 
-#include <Arduino.h>
+#include "hal.h"
+
+// Ultrasonic sensor slots (one per HC-SR04)
+enum SensorId {
+  SENSOR_LEFT,
+  SENSOR_RIGHT,
+  SENSOR_FRONT,
+  SENSOR_FRONT_LEFT,
+  SENSOR_FRONT_RIGHT,
+  SENSOR_COUNT
+};
+
+// Echo is treated as lost after this long (~5 m round trip)
+#define ECHO_TIMEOUT_US 30000UL
+
+// Filtering pipeline
+#define SENSOR_HISTORY 5         // Readings kept per sensor for the median
+#define SENSOR_MAX_RANGE_CM 400  // Reported when nothing echoes back
+#define SENSOR_STALE_MS 500      // Older readings are marked invalid
+#define MAX_OUTLIER_STREAK 3     // Repeated jumps are real, not noise
+#define OUTLIER_MATCH_CM 10      // Rejected readings this close agree
+
+// Filtered reading for one direction
+struct SensorReading {
+  long distance;        // Median-filtered distance in cm
+  unsigned long ageMs;  // Time since the last accepted reading
+  bool valid;           // False until the first reading, or once it goes stale
+};
+
+// One consistent view of all five directions, indexed by SensorId
+struct SensorSnapshot {
+  SensorReading readings[SENSOR_COUNT];
+};
 
 // Function declarations for sensor operations
-long getDistance(int trigPin, int echoPin);
+void initializeSensors();
+void updateRanging();
+void beginSensorCycle();
+const SensorReading &readSensor(SensorId id);
+const SensorSnapshot &getSensorSnapshot();
+long sensorClearance(const SensorReading &reading);
+bool sensorObstacle(SensorId id);
 bool getFrontIRObstacle();
 long getFrontDistance();
 
+// Static RAM of ranging slots, filters and caches (memory report)
+extern const unsigned int sensorsRamBytes;
+
 #endif
@@ -0,0 +1,86 @@
+#include "telemetry.h"
+#include "log.h"
+#include "memory.h"
+#include "navigation.h"
+#include "protocol.h"
+#include "scheduler.h"
+
+static_assert(2 + TELEMETRY_FIELD_COUNT <= BINARY_MAX_VALUE,
+              "A keyframe must fit in one binary frame");
+
+static byte telemetryRate = 0;  // Off until the app asks for it
+static unsigned long lastFrameTime = 0;
+static byte frameCount = 0;
+static byte sinceKeyframe = TELEMETRY_KEYFRAME_INTERVAL;
+static byte lastSent[TELEMETRY_FIELD_COUNT];
+static unsigned long loopPeakUs = 0;  // Longest pass since the last frame
+
+// 0 stops the stream. Returns false for rates the link cannot carry
+bool setTelemetryRate(byte framesPerSecond) {
+  if (framesPerSecond > TELEMETRY_MAX_RATE) return false;
+
+  telemetryRate = framesPerSecond;
+  sinceKeyframe = TELEMETRY_KEYFRAME_INTERVAL;  // Start with a full frame
+  LOG_INFO(MSG_TELEMETRY_RATE, framesPerSecond);
+  return true;
+}
+
+static void readFields(byte *fields) {
+  fields[TELEMETRY_MODE] = binaryMode();
+  fields[TELEMETRY_COMPONENTS] = componentStates();
+  fields[TELEMETRY_NAV_STATE] = getNavigationState();
+  loopPeakUs = max(loopPeakUs, takeMaxTickUs());  // Kept over skipped frames
+  fields[TELEMETRY_LOOP] = min(loopPeakUs / 100, 255UL);
+
+  const SensorSnapshot &snapshot = getSensorSnapshot();
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    const SensorReading &reading = snapshot.readings[i];
+    fields[TELEMETRY_DISTANCE + i] =
+        reading.valid ? min(reading.distance / 2, 254L) : TELEMETRY_NO_READING;
+  }
+
+  // The high-water scan itself runs in the memory task
+  fields[TELEMETRY_FREE_RAM] = min(getMemoryStats().freeLowest / 32, 255U);
+}
+
+// Publish the next frame if one is due. A frame that would not fit in the
+// Serial3 transmit buffer is retried on the next tick rather than waited for,
+// so telemetry never holds up command replies
+void updateTelemetry() {
+  if (telemetryRate == 0 ||
+      halMillis() - lastFrameTime < 1000UL / telemetryRate) {
+    return;
+  }
+
+  byte fields[TELEMETRY_FIELD_COUNT];
+  readFields(fields);
+  bool keyframe = sinceKeyframe >= TELEMETRY_KEYFRAME_INTERVAL;
+
+  byte value[2 + TELEMETRY_FIELD_COUNT];
+  byte length = 2;
+  uint16_t mask = 0;
+  for (byte i = 0; i < TELEMETRY_FIELD_COUNT; i++) {
+    if (keyframe || fields[i] != lastSent[i]) {
+      mask |= 1 << i;
+      value[length++] = fields[i];
+    }
+  }
+  if (mask == 0) {
+    lastFrameTime = halMillis();
+    loopPeakUs = 0;
+    sinceKeyframe++;
+    return;  // Nothing changed
+  }
+  value[0] = mask & 0xFF;
+  value[1] = mask >> 8;
+
+  if (halUartAvailableForWrite(HAL_UART_BLE) <
+      BINARY_HEADER_LENGTH + length + 1) {
+    return;  // Link busy - try again next tick
+  }
+  sendBinaryFrame(frameCount++, TELEMETRY_OPCODE, value, length);
+  lastFrameTime = halMillis();
+  loopPeakUs = 0;
+  memcpy(lastSent, fields, sizeof(lastSent));
+  sinceKeyframe = keyframe ? 1 : sinceKeyframe + 1;
+}
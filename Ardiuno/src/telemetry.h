@@ -0,0 +1,35 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "hal.h"
+#include "sensors.h"
+
+// Telemetry frames use the binary frame layout from protocol.h with opcode
+// TELEMETRY_OPCODE and a running frame counter as the sequence number:
+//   field mask (2 bytes, little endian), then one byte per field in the mask,
+//   lowest bit first
+// Keyframes carry every field; the frames in between only the fields that
+// changed since the last frame sent, and nothing at all if none did
+#define TELEMETRY_OPCODE 0xC0  // Sent by the robot unasked, never a reply
+
+enum TelemetryField {
+  TELEMETRY_MODE,        // BinaryMode
+  TELEMETRY_COMPONENTS,  // COMPONENT_* bits
+  TELEMETRY_NAV_STATE,   // NavState
+  TELEMETRY_LOOP,        // Longest scheduler pass since last frame, 0.1 ms
+  TELEMETRY_DISTANCE,    // SENSOR_COUNT fields in SensorId order: cm / 2,
+                         // TELEMETRY_NO_READING if invalid
+  TELEMETRY_FREE_RAM = TELEMETRY_DISTANCE + SENSOR_COUNT,  // Lowest since
+                                                           // boot, 32 bytes
+  TELEMETRY_FIELD_COUNT
+};
+
+#define TELEMETRY_NO_READING 0xFF
+#define TELEMETRY_MAX_RATE 20          // Frames per second
+#define TELEMETRY_KEYFRAME_INTERVAL 10  // Every 10th frame carries everything
+
+// Function declarations for the telemetry stream
+bool setTelemetryRate(byte framesPerSecond);
+void updateTelemetry();
+
+#endif
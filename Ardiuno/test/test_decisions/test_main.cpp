@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <unity.h>
+#include "decisions.h"
+
+// Every obstacle mask, written out by hand (set bits: L FL F FR R)
+static const byte expectedDrive[MASK_COUNT] = {
+    MANOEUVRE_FORWARD,            // Clear
+    MANOEUVRE_NUDGE_RIGHT,        // L
+    MANOEUVRE_CLEAR_RIGHT,        // FL
+    MANOEUVRE_CLEAR_RIGHT,        // L FL
+    MANOEUVRE_TOWARD_CLEARER,     // F
+    MANOEUVRE_TOWARD_CLEARER,     // L F
+    MANOEUVRE_TURN_RIGHT,         // FL F
+    MANOEUVRE_TURN_RIGHT,         // L FL F
+    MANOEUVRE_CLEAR_LEFT,         // FR
+    MANOEUVRE_CLEAR_LEFT,         // L FR
+    MANOEUVRE_BACK_UP_AND_PAUSE,  // FL FR
+    MANOEUVRE_BACK_UP_AND_PAUSE,  // L FL FR
+    MANOEUVRE_TURN_LEFT,          // F FR
+    MANOEUVRE_TURN_LEFT,          // L F FR
+    MANOEUVRE_U_TURN,             // FL F FR
+    MANOEUVRE_U_TURN,             // L FL F FR
+    MANOEUVRE_NUDGE_LEFT,         // R
+    MANOEUVRE_BACK_UP,            // L R
+    MANOEUVRE_CLEAR_RIGHT,        // FL R
+    MANOEUVRE_CLEAR_RIGHT,        // L FL R
+    MANOEUVRE_TOWARD_CLEARER,     // F R
+    MANOEUVRE_TOWARD_CLEARER,     // L F R
+    MANOEUVRE_TURN_RIGHT,         // FL F R
+    MANOEUVRE_TURN_RIGHT,         // L FL F R
+    MANOEUVRE_CLEAR_LEFT,         // FR R
+    MANOEUVRE_CLEAR_LEFT,         // L FR R
+    MANOEUVRE_BACK_UP_AND_PAUSE,  // FL FR R
+    MANOEUVRE_BACK_UP_AND_PAUSE,  // L FL FR R
+    MANOEUVRE_TURN_LEFT,          // F FR R
+    MANOEUVRE_TURN_LEFT,          // L F FR R
+    MANOEUVRE_U_TURN,             // FL F FR R
+    MANOEUVRE_U_TURN              // L FL F FR R
+};
+
+static const byte expectedAvoid[MASK_COUNT] = {
+    MANOEUVRE_AVOID_LEFT,            // Clear
+    MANOEUVRE_AVOID_RIGHT,           // L
+    MANOEUVRE_AVOID_RIGHT,           // FL
+    MANOEUVRE_AVOID_RIGHT,           // L FL
+    MANOEUVRE_AVOID_LEFT,            // F
+    MANOEUVRE_AVOID_RIGHT,           // L F
+    MANOEUVRE_AVOID_RIGHT,           // FL F
+    MANOEUVRE_AVOID_RIGHT,           // L FL F
+    MANOEUVRE_AVOID_LEFT,            // FR
+    MANOEUVRE_AVOID_LEFT,            // L FR
+    MANOEUVRE_BACK_UP_AND_TURN,      // FL FR
+    MANOEUVRE_BACK_UP_AND_TURN,      // L FL FR
+    MANOEUVRE_AVOID_LEFT,            // F FR
+    MANOEUVRE_AVOID_LEFT,            // L F FR
+    MANOEUVRE_BACK_UP_AND_TURN,      // FL F FR
+    MANOEUVRE_BACK_UP_AND_TURN,      // L FL F FR
+    MANOEUVRE_AVOID_LEFT,            // R
+    MANOEUVRE_AVOID_TOWARD_CLEARER,  // L R
+    MANOEUVRE_AVOID_RIGHT,           // FL R
+    MANOEUVRE_AVOID_RIGHT,           // L FL R
+    MANOEUVRE_AVOID_LEFT,            // F R
+    MANOEUVRE_AVOID_TOWARD_CLEARER,  // L F R
+    MANOEUVRE_AVOID_RIGHT,           // FL F R
+    MANOEUVRE_AVOID_RIGHT,           // L FL F R
+    MANOEUVRE_AVOID_LEFT,            // FR R
+    MANOEUVRE_AVOID_LEFT,            // L FR R
+    MANOEUVRE_BACK_UP_AND_TURN,      // FL FR R
+    MANOEUVRE_BACK_UP_AND_TURN,      // L FL FR R
+    MANOEUVRE_AVOID_LEFT,            // F FR R
+    MANOEUVRE_AVOID_LEFT,            // L F FR R
+    MANOEUVRE_BACK_UP_AND_TURN,      // FL F FR R
+    MANOEUVRE_BACK_UP_AND_TURN       // L FL F FR R
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+static void test_drive_rows() {
+  for (byte mask = 0; mask < MASK_COUNT; mask++) {
+    char row[12];
+    snprintf(row, sizeof(row), "mask %u", mask);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(expectedDrive[mask], driveManoeuvre(mask),
+                                    row);
+  }
+}
+
+static void test_avoid_rows() {
+  for (byte mask = 0; mask < MASK_COUNT; mask++) {
+    char row[12];
+    snprintf(row, sizeof(row), "mask %u", mask);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(expectedAvoid[mask], avoidManoeuvre(mask),
+                                    row);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_drive_rows);
+  RUN_TEST(test_avoid_rows);
+  return UNITY_END();
+}
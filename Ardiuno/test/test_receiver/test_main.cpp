@@ -0,0 +1,178 @@
+#include <unity.h>
+#include "config.h"
+#include "log.h"
+#include "protocol.h"
+#include "receiver.h"
+
+// Commands go in through the HM-10 UART and replies come back out of it, the
+// way the app sees them
+static byte reply[256];
+static size_t replyLength;
+
+static void send(const byte *data, size_t length) {
+  halUartInject(HAL_UART_BLE, data, length);
+  while (pollBLEReceiver()) {
+  }
+  replyLength = halUartTake(HAL_UART_BLE, reply, sizeof(reply) - 1);
+  reply[replyLength] = '\0';
+}
+
+static void sendText(const char *text) {
+  send((const byte *)text, strlen(text));
+}
+
+// Binary command frame with its CRC
+static void sendBinary(byte sequence, byte opcode, const byte *value,
+                       byte length) {
+  byte frame[BINARY_HEADER_LENGTH + BINARY_MAX_VALUE + 1] = {
+      BINARY_FRAME_MAGIC, sequence, opcode, length};
+  for (byte i = 0; i < length; i++) {
+    frame[BINARY_HEADER_LENGTH + i] = value[i];
+  }
+  frame[BINARY_HEADER_LENGTH + length] =
+      crc8(frame + 1, BINARY_HEADER_LENGTH - 1 + length);
+  send(frame, BINARY_HEADER_LENGTH + length + 1);
+}
+
+// Check a binary response frame and return its status byte
+static byte responseStatus(byte sequence, byte opcode) {
+  TEST_ASSERT_TRUE(replyLength >= BINARY_HEADER_LENGTH + 2);
+  TEST_ASSERT_EQUAL_UINT8(BINARY_FRAME_MAGIC, reply[0]);
+  TEST_ASSERT_EQUAL_UINT8(sequence, reply[1]);
+  TEST_ASSERT_EQUAL_UINT8(opcode | BINARY_RESPONSE_FLAG, reply[2]);
+  TEST_ASSERT_EQUAL(BINARY_HEADER_LENGTH + reply[3] + 1, replyLength);
+  TEST_ASSERT_EQUAL_UINT8(crc8(reply + 1, replyLength - 2),
+                          reply[replyLength - 1]);
+  return reply[BINARY_HEADER_LENGTH];
+}
+
+void setUp() {
+  autoMode = false;
+}
+
+void tearDown() {}
+
+static void test_text_command() {
+  sendText("test\n");
+  TEST_ASSERT_EQUAL_STRING("ACK:TEST\r\nTEST_OK\r\n", (const char *)reply);
+}
+
+// CRLF, and several commands in one packet, each get their own reply
+static void test_packed_commands() {
+  sendText("test\r\ntest\n");
+  TEST_ASSERT_EQUAL_STRING("ACK:TEST\r\nTEST_OK\r\nACK:TEST\r\nTEST_OK\r\n",
+                           (const char *)reply);
+}
+
+// Older app builds send no newline: the command runs once the link goes quiet
+static void test_unterminated_command() {
+  sendText("test");
+  TEST_ASSERT_EQUAL(0, replyLength);
+
+  halAdvanceMicros(FRAME_IDLE_GAP_MS * 1000UL);
+  sendText("");
+  TEST_ASSERT_EQUAL_STRING("ACK:TEST\r\nTEST_OK\r\n", (const char *)reply);
+}
+
+static void test_binary_status() {
+  sendBinary(7, OP_STATUS, NULL, 0);
+  TEST_ASSERT_EQUAL_UINT8(STATUS_OK, responseStatus(7, OP_STATUS));
+  TEST_ASSERT_EQUAL(3, reply[3]);
+  TEST_ASSERT_EQUAL_UINT8(MODE_MANUAL, reply[BINARY_HEADER_LENGTH + 1]);
+}
+
+static void test_binary_move_refused_in_auto() {
+  const byte forward[] = {DIR_FORWARD};
+  sendBinary(8, OP_MOVE, forward, sizeof(forward));
+  TEST_ASSERT_EQUAL_UINT8(STATUS_OK, responseStatus(8, OP_MOVE));
+
+  autoMode = true;
+  sendBinary(9, OP_MOVE, forward, sizeof(forward));
+  TEST_ASSERT_EQUAL_UINT8(STATUS_REJECTED, responseStatus(9, OP_MOVE));
+}
+
+static void test_binary_bad_crc() {
+  const byte frame[] = {BINARY_FRAME_MAGIC, 10, OP_STATUS, 0, 0x00};
+  send(frame, sizeof(frame));
+  TEST_ASSERT_EQUAL_UINT8(STATUS_BAD_CRC, responseStatus(10, OP_STATUS));
+}
+
+// Two chunks sent last-first still make one command, acknowledged once
+static void test_chunks_out_of_order() {
+  const char *command = "UNKNOWN_LONG_COMMAND";  // 15 + 5 bytes
+  byte second[] = {CHUNK_FRAME_MAGIC, 3 + 5, 42, 1, 1};
+  byte first[] = {CHUNK_FRAME_MAGIC, 3 + 15, 42, 0, 1};
+  byte frame[CHUNK_FRAME_MAX];
+
+  memcpy(frame, second, sizeof(second));
+  memcpy(frame + sizeof(second), command + 15, 5);
+  send(frame, sizeof(second) + 5);
+  TEST_ASSERT_EQUAL_STRING("CHUNK_NACK:42:0\r\n", (const char *)reply);
+
+  memcpy(frame, first, sizeof(first));
+  memcpy(frame + sizeof(first), command, 15);
+  send(frame, sizeof(first) + 15);
+  TEST_ASSERT_EQUAL_STRING(
+      "CHUNK_ACK:42\r\n"
+      "ACK:UNKNOWN_LONG_COMMAND\r\n"
+      "UNKNOWN_COMMAND:UNKNOWN_LONG_COMMAND\r\n",
+      (const char *)reply);
+}
+
+// True if the firmware logged this message since the last call
+static bool logged(MessageId id) {
+  byte output[LOG_BUFFER_SIZE];
+  size_t length = 0;
+  size_t taken;
+  do {
+    drainLog();
+    taken = halUartTake(HAL_UART_DEBUG, output + length,
+                        sizeof(output) - length);
+    length += taken;
+  } while (taken > 0);
+
+  bool found = false;
+  for (size_t i = 0; i + 1 < length; i++) {
+    if (output[i] == LOG_RECORD_MAGIC && output[i + 1] == id) found = true;
+  }
+  return found;
+}
+
+// The payload length byte may not run the frame past one HM-10 packet
+static void test_chunk_frame_length_limit() {
+  byte frame[CHUNK_FRAME_MAX + 1] = {CHUNK_FRAME_MAGIC, CHUNK_PAYLOAD_MAX + 1,
+                                     43, 0, 0};
+  memset(frame + 5, 'X', sizeof(frame) - 5);
+  logged(MSG_BAD_CHUNK_FRAME);
+  send(frame, sizeof(frame));
+  TEST_ASSERT_TRUE(logged(MSG_BAD_CHUNK_FRAME));
+
+  // The rest of the packet is dropped as text once the link goes quiet
+  halAdvanceMicros(FRAME_IDLE_GAP_MS * 1000UL);
+  sendText("");
+
+  // The largest payload that fits is still taken
+  const byte full[CHUNK_FRAME_MAX] = {CHUNK_FRAME_MAGIC, CHUNK_PAYLOAD_MAX, 44,
+                                      0, 0, 'T', 'E', 'S', 'T', 'T', 'E', 'S',
+                                      'T', 'T', 'E', 'S', 'T', 'T', 'E', 'S'};
+  send(full, sizeof(full));
+  TEST_ASSERT_FALSE(logged(MSG_BAD_CHUNK_FRAME));
+  TEST_ASSERT_EQUAL_STRING(
+      "CHUNK_ACK:44\r\n"
+      "ACK:TESTTESTTESTTES\r\n"
+      "UNKNOWN_COMMAND:TESTTESTTESTTES\r\n",
+      (const char *)reply);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_text_command);
+  RUN_TEST(test_packed_commands);
+  RUN_TEST(test_unterminated_command);
+  RUN_TEST(test_binary_status);
+  RUN_TEST(test_binary_move_refused_in_auto);
+  RUN_TEST(test_binary_bad_crc);
+  RUN_TEST(test_chunks_out_of_order);
+  RUN_TEST(test_chunk_frame_length_limit);
+  return UNITY_END();
+}
@@ -0,0 +1,160 @@
+#include <unity.h>
+#include "config.h"
+#include "sensors.h"
+
+// A room of walls around the robot, one distance per sensor. A pinged
+// sensor raises its echo pin and drops it after the round trip, like an
+// HC-SR04; the special distances model a sensor with nothing in range (echo
+// held high until the module gives up) and a dead one (echo never rises)
+#define NOTHING_IN_RANGE -1
+#define DEAD_SENSOR -2
+#define HC_SR04_GIVE_UP_US 38000UL
+
+static long wallCm[SENSOR_COUNT];
+static int *const trigPins[SENSOR_COUNT] = {&leftTrigPin, &rightTrigPin,
+                                            &frontTrigPin, &frontLeftTrigPin,
+                                            &frontRightTrigPin};
+static int *const echoPins[SENSOR_COUNT] = {&leftEchoPin, &rightEchoPin,
+                                            &frontEchoPin, &frontLeftEchoPin,
+                                            &frontRightEchoPin};
+static unsigned int triggersSeen[SENSOR_COUNT];
+static unsigned long giveUpAt[SENSOR_COUNT];  // When a held echo drops
+
+static unsigned long roundTripUs(long cm) {
+  return (cm + 0.5) * 2 / 0.034;
+}
+
+// Answer whatever the last updateRanging() fired
+static void answerPings() {
+  bool pinged[SENSOR_COUNT];
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    unsigned int triggers = halPinRises(*trigPins[i]);
+    pinged[i] = triggers != triggersSeen[i] && wallCm[i] != DEAD_SENSOR;
+    triggersSeen[i] = triggers;
+
+    // Held echoes drop once the module gives up
+    if (halDigitalRead(*echoPins[i]) == HIGH &&
+        (long)(halMicros() - giveUpAt[i]) >= 0) {
+      halSetPinInput(*echoPins[i], LOW);
+    }
+    if (!pinged[i]) continue;
+    halSetPinInput(*echoPins[i], HIGH);
+    giveUpAt[i] = halMicros() + HC_SR04_GIVE_UP_US;
+  }
+
+  // Walls in range answer nearest first
+  unsigned long elapsed = 0;
+  while (true) {
+    int next = -1;
+    for (byte i = 0; i < SENSOR_COUNT; i++) {
+      if (pinged[i] && wallCm[i] >= 0 &&
+          (next < 0 || wallCm[i] < wallCm[next])) {
+        next = i;
+      }
+    }
+    if (next < 0) break;
+    unsigned long due = roundTripUs(wallCm[next]);
+    halAdvanceMicros(due - elapsed);
+    elapsed = due;
+    halSetPinInput(*echoPins[next], LOW);
+    pinged[next] = false;
+  }
+}
+
+// Run the ranging loop for a while, one pass per simulated millisecond
+static void rangeFor(unsigned long ms) {
+  unsigned long end = halMillis() + ms;
+  while ((long)(halMillis() - end) < 0) {
+    updateRanging();
+    answerPings();
+    halAdvanceMicros(1000);
+  }
+}
+
+static const SensorReading &front() {
+  beginSensorCycle();
+  return readSensor(SENSOR_FRONT);
+}
+
+void setUp() {
+  for (byte i = 0; i < SENSOR_COUNT; i++) {
+    wallCm[i] = 150;
+    triggersSeen[i] = halPinRises(*trigPins[i]);
+    halSetPinInput(*echoPins[i], LOW);
+  }
+  wallCm[SENSOR_FRONT] = 100;
+  initializeSensors();
+  rangeFor(500);
+}
+
+void tearDown() {}
+
+static void test_steady_wall() {
+  TEST_ASSERT_TRUE(front().valid);
+  TEST_ASSERT_INT_WITHIN(1, 100, front().distance);
+  TEST_ASSERT_INT_WITHIN(1, 150, readSensor(SENSOR_LEFT).distance);
+}
+
+// Fewer than MAX_OUTLIER_STREAK wild readings never reach the output
+static void test_spike_rejected() {
+  wallCm[SENSOR_FRONT] = 20;
+  unsigned long end = halMillis() + 90;  // At most two front pings
+  while ((long)(halMillis() - end) < 0) {
+    rangeFor(1);
+    TEST_ASSERT_INT_WITHIN(1, 100, front().distance);
+  }
+
+  wallCm[SENSOR_FRONT] = 100;
+  rangeFor(200);
+  TEST_ASSERT_INT_WITHIN(1, 100, front().distance);
+}
+
+// A jump that keeps repeating is real and replaces the median outright
+static void test_step_accepted() {
+  wallCm[SENSOR_FRONT] = 30;
+  unsigned long start = halMillis();
+  while (front().distance > 31) {
+    TEST_ASSERT_TRUE(halMillis() - start < 1000);
+    rangeFor(1);
+  }
+  // MAX_OUTLIER_STREAK front pings at 20 Hz, plus one ping group of slack
+  TEST_ASSERT_LESS_OR_EQUAL(200, halMillis() - start);
+  TEST_ASSERT_INT_WITHIN(1, 30, front().distance);
+}
+
+// A sensor that stops reporting goes invalid and counts as blocked
+static void test_stalled_sensor_blocked() {
+  halAdvanceMicros((SENSOR_STALE_MS + 100) * 1000UL);
+  TEST_ASSERT_FALSE(front().valid);
+  TEST_ASSERT_EQUAL(0, sensorClearance(front()));
+  TEST_ASSERT_TRUE(getFrontIRObstacle());
+}
+
+// Nothing in range is open space: the echo stays high past the timeout
+static void test_nothing_in_range() {
+  wallCm[SENSOR_FRONT] = NOTHING_IN_RANGE;
+  rangeFor(300);
+  TEST_ASSERT_TRUE(front().valid);
+  TEST_ASSERT_EQUAL(SENSOR_MAX_RANGE_CM, front().distance);
+  TEST_ASSERT_FALSE(getFrontIRObstacle());
+}
+
+// A sensor whose echo never rises keeps being pinged but never reads as open
+static void test_dead_sensor_blocked() {
+  wallCm[SENSOR_FRONT] = DEAD_SENSOR;
+  rangeFor(SENSOR_STALE_MS + 100);
+  TEST_ASSERT_FALSE(front().valid);
+  TEST_ASSERT_EQUAL(0, sensorClearance(front()));
+  TEST_ASSERT_TRUE(getFrontIRObstacle());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_steady_wall);
+  RUN_TEST(test_spike_rejected);
+  RUN_TEST(test_step_accepted);
+  RUN_TEST(test_stalled_sensor_blocked);
+  RUN_TEST(test_nothing_in_range);
+  RUN_TEST(test_dead_sensor_blocked);
+  return UNITY_END();
+}
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Turn the robot's binary log records back into text.
+
+The firmware sends each log line as
+    0x1E, message id, argument byte count, arguments
+where the id is the message's position among the MESSAGE(...) entries of
+src/messages.def, counting from 0 (see log.h). Bytes outside a record are
+passed through unchanged.
+
+Usage:
+    python tools/decode_log.py /dev/ttyACM0      # needs pyserial
+    python tools/decode_log.py capture.bin
+    pio device monitor --raw | python tools/decode_log.py -
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+RECORD_MAGIC = 0x1E
+DEFAULT_CATALOG = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                               "..", "src", "messages.def")
+
+MESSAGE_RE = re.compile(r'^\s*MESSAGE\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+FORMAT_RE = re.compile(r"%(\.\d+)?([dsuxf%])")
+
+
+def load_catalog(path):
+    """Message formats in id order, exactly as the firmware enum numbers them."""
+    catalog = []
+    with open(path, encoding="utf-8") as source:
+        for line in source:
+            match = MESSAGE_RE.match(line)
+            if match:
+                text = re.sub(r"\\(.)", r"\1", match.group(2))
+                catalog.append((match.group(1), text))
+    return catalog
+
+
+class ArgumentReader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.data[self.offset]
+            self.offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return (value >> 1) ^ -(value & 1)  # Undo the zigzag
+
+    def float(self):
+        (value,) = struct.unpack_from("<f", self.data, self.offset)
+        self.offset += 4
+        return value
+
+    def string(self):
+        length = self.data[self.offset]
+        text = self.data[self.offset + 1:self.offset + 1 + length]
+        if len(text) < length:
+            raise IndexError
+        self.offset += 1 + length
+        return text.decode("utf-8", errors="replace")
+
+
+def format_message(text, arguments):
+    reader = ArgumentReader(arguments)
+
+    def replace(match):
+        precision, kind = match.groups()
+        if kind == "%":
+            return "%"
+        try:
+            if kind == "s":
+                return reader.string()
+            if kind == "f":
+                return ("%" + (precision or "") + "f") % reader.float()
+            value = reader.varint()
+            if kind == "u":
+                return str(value & 0xFFFFFFFF)
+            if kind == "x":
+                return "%X" % (value & 0xFFFFFFFF)
+            return str(value)
+        except (IndexError, struct.error):
+            return "?"  # Left off on the robot because the record was full
+
+    return FORMAT_RE.sub(replace, text)
+
+
+def decode(stream, catalog, output):
+    """Read bytes until the stream ends, writing decoded lines to output."""
+    text = bytearray()
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            break
+        if byte[0] != RECORD_MAGIC:
+            text += byte
+            if byte == b"\n":
+                output.write(text.decode("utf-8", errors="replace"))
+                text.clear()
+            continue
+
+        header = stream.read(2)
+        if len(header) < 2:
+            break
+        message_id, length = header
+        arguments = stream.read(length)
+        if message_id < len(catalog):
+            line = format_message(catalog[message_id][1], arguments)
+        else:
+            line = "<unknown message %d: %s>" % (message_id, arguments.hex())
+        output.write(line + "\n")
+        output.flush()
+
+
+def open_source(name, baud):
+    if name == "-":
+        return sys.stdin.buffer
+    if os.path.isfile(name):
+        return open(name, "rb")
+    import serial  # pyserial, only needed for a live port
+
+    return serial.Serial(name, baud)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="serial port, capture file or - for stdin")
+    parser.add_argument("--baud", type=int, default=9600)
+    parser.add_argument("--catalog", default=DEFAULT_CATALOG,
+                        help="messages.def of the firmware that is running")
+    args = parser.parse_args()
+
+    catalog = load_catalog(args.catalog)
+    try:
+        decode(open_source(args.source, args.baud), catalog, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
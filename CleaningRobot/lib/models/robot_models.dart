@@ -64,6 +64,8 @@ class RobotCommands {
       jsonEncode({"a": "o", "t": "a"}); // {"a":"o","t":"a"} = 15 bytes
   static String manualMode =
       jsonEncode({"a": "o", "t": "m"}); // {"a":"o","t":"m"} = 15 bytes
+  static String coverageMode =
+      jsonEncode({"a": "o", "t": "c"}); // {"a":"o","t":"c"} = 15 bytes
 
   // Ultra-short status commands
   static String getStatus = jsonEncode({"a": "s"}); // {"a":"s"} = 9 bytes
@@ -169,6 +171,109 @@ class RobotCommands {
   }
 }
 
+// Compact binary commands, one BLE packet each (see protocol.h on the robot):
+// [magic, sequence, opcode, length, value..., CRC-8]
+class BinaryCommands {
+  static const int magic = 0xB5;
+  static const int opMove = 0x01;
+  static const int opComponents = 0x02;
+  static const int opMode = 0x03;
+  static const int opStatus = 0x04;
+  static const int opEmergency = 0x05;
+  static const int opTelemetry = 0x07;
+  static const int opMemory = 0x08;
+
+  static const Map<String, int> _directions = {
+    's': 0,
+    'f': 1,
+    'b': 2,
+    'l': 3,
+    'r': 4,
+  };
+  static int _sequence = 0;
+
+  // CRC-8, polynomial 0x07, initial value 0
+  static int crc8(List<int> data) {
+    int crc = 0;
+    for (final byte in data) {
+      crc ^= byte;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1;
+        crc &= 0xFF;
+      }
+    }
+    return crc;
+  }
+
+  static List<int> build(int opcode, [List<int> value = const []]) {
+    _sequence = (_sequence + 1) & 0xFF;
+    final body = [_sequence, opcode, value.length, ...value];
+    return [magic, ...body, crc8(body)];
+  }
+
+  // Short direction code ("f", "b", "l", "r" or "s") to a 6-byte move command
+  static List<int> move(String direction) =>
+      build(opMove, [_directions[direction] ?? 0]);
+
+  // Ask for telemetry frames at this rate (0 stops them, at most 20)
+  static List<int> telemetryRate(int framesPerSecond) =>
+      build(opTelemetry, [framesPerSecond]);
+
+  // Ask for RAM figures: the reply carries static RAM, stack peak, lowest
+  // free RAM and heap in use as 16-bit little-endian byte counts
+  static List<int> memory() => build(opMemory);
+}
+
+// Live robot state from the telemetry stream (see telemetry.h on the robot).
+// Frames only carry the fields that changed, so this keeps the last value of
+// every field and overwrites the ones each frame brings
+class RobotTelemetry {
+  static const int opcode = 0xC0;
+  static const int noReading = 0xFF;
+  static const List<String> sensorNames = [
+    'left',
+    'right',
+    'front',
+    'frontLeft',
+    'frontRight',
+  ];
+
+  // mode, components, nav state, loop time, one byte per sensor, free RAM
+  final List<int> _fields = List.filled(5 + sensorNames.length, 0);
+  bool hasKeyframe = false;
+
+  int get mode => _fields[0]; // 0 manual, 1 bounce, 2 coverage
+  bool get vacuumActive => (_fields[1] & 0x01) != 0;
+  bool get mopActive => (_fields[1] & 0x02) != 0;
+  bool get pumpActive => (_fields[1] & 0x04) != 0;
+  int get navigationState => _fields[2];
+  double get loopMs => _fields[3] / 10.0;
+
+  // Filtered distance in cm, or null if the sensor has no reading
+  int? distanceCm(int sensor) {
+    final value = _fields[4 + sensor];
+    return value == noReading ? null : value * 2;
+  }
+
+  // Least free RAM between heap and stack since the robot booted, in bytes
+  int get lowestFreeRam => _fields[4 + sensorNames.length] * 32;
+
+  // Apply the value bytes of one telemetry frame: 2-byte field mask, then
+  // one byte per field in the mask. Returns false if the frame is malformed
+  bool apply(List<int> value) {
+    if (value.length < 2) return false;
+    final mask = value[0] | (value[1] << 8);
+    int next = 2;
+    for (int i = 0; i < _fields.length; i++) {
+      if ((mask & (1 << i)) == 0) continue;
+      if (next >= value.length) return false;
+      _fields[i] = value[next++];
+    }
+    if (mask == (1 << _fields.length) - 1) hasKeyframe = true;
+    return true;
+  }
+}
+
 enum RobotState {
   idle,
   moving,
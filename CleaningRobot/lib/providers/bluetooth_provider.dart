@@ -3,8 +3,17 @@ import 'dart:convert';
 import 'package:flutter/material.dart';
 import 'package:flutter_blue_plus/flutter_blue_plus.dart';
 import 'package:permission_handler/permission_handler.dart';
+import '../models/robot_models.dart' show BinaryCommands, RobotTelemetry;
 
 class BluetoothProvider extends ChangeNotifier {
+  // First byte of a binary chunk frame (text commands never start with it)
+  static const int _chunkFrameMagic = 0xA5;
+
+  // Chunked command being delivered: frames kept until the robot's
+  // CHUNK_ACK so chunks it reports missing (CHUNK_NACK) can be resent
+  int _chunkMessageId = 0;
+  List<List<int>> _pendingChunks = [];
+
   BluetoothDevice? _connectedDevice;
   BluetoothConnectionState _connectionState =
       BluetoothConnectionState.disconnected;
@@ -22,6 +31,16 @@ class BluetoothProvider extends ChangeNotifier {
   // JSON response handling
   Function(String)? _responseCallback;
 
+  // Binary telemetry stream; bytes are held until a whole frame is in
+  static const int _telemetryRate = 10;
+  final RobotTelemetry _telemetry = RobotTelemetry();
+  final List<int> _binaryBytes = [];
+
+  // Text reply line still waiting for its newline; a CHUNK_ACK/NACK may be
+  // split across two notifications
+  static const int _maxReplyLine = 64;
+  String _replyLine = '';
+
   // Minimal command delay for maximum responsiveness
   DateTime? _lastCommandTime;
   static const Duration _commandDelay = Duration(milliseconds: 20);
@@ -39,6 +58,7 @@ class BluetoothProvider extends ChangeNotifier {
   bool get isBluetoothEnabled => _isBluetoothEnabled;
   bool get isScanning => _isScanning;
   String? get errorMessage => _errorMessage;
+  RobotTelemetry get telemetry => _telemetry;
   bool get isConnected =>
       _connectionState == BluetoothConnectionState.connected;
 
@@ -339,14 +359,70 @@ class BluetoothProvider extends ChangeNotifier {
 
   void _onDataReceived(List<int> data) {
     // Handle incoming data from robot (for debugging only - no JSON responses expected)
-    String message = utf8.decode(data);
-    debugPrint('Received from HM-10: $message');
+    // Binary command replies are not UTF-8, so decode leniently
+    String message = utf8.decode(data, allowMalformed: true);
+    debugPrint('Received from HM-10: $message (bytes: $data)');
+    _collectReplyLines(message);
 
     // Since we don't expect JSON responses, we can optionally process
     // raw data for debugging purposes only
     if (_responseCallback != null) {
       _responseCallback!(message);
     }
+
+    _collectTelemetry(data);
+  }
+
+  // Hand complete text lines to the chunk sender, keeping the unterminated
+  // tail for the next notification
+  void _collectReplyLines(String message) {
+    final lines = (_replyLine + message).split('\n');
+    _replyLine = lines.removeLast();
+    if (_replyLine.length > _maxReplyLine) {
+      // Binary frames have no newline - keep only what could start a reply
+      _replyLine = _replyLine.substring(_replyLine.length - _maxReplyLine);
+    }
+    for (String line in lines) {
+      line = line.trim();
+      if (line.startsWith('CHUNK_')) _handleChunkReply(line);
+    }
+  }
+
+  // Pick telemetry frames [0xB5, sequence, 0xC0, length, value..., CRC-8]
+  // out of the received bytes; a frame may span several notifications
+  void _collectTelemetry(List<int> data) {
+    _binaryBytes.addAll(data);
+    bool updated = false;
+
+    while (true) {
+      final start = _binaryBytes.indexOf(BinaryCommands.magic);
+      if (start < 0) {
+        _binaryBytes.clear();
+        break;
+      }
+      _binaryBytes.removeRange(0, start);
+      if (_binaryBytes.length < 4) break;
+
+      final frameLength = 4 + _binaryBytes[3] + 1;
+      if (_binaryBytes[3] > 15) {
+        _binaryBytes.removeAt(0);
+        continue;
+      }
+      if (_binaryBytes.length < frameLength) break;
+
+      final body = _binaryBytes.sublist(1, frameLength - 1);
+      if (BinaryCommands.crc8(body) == _binaryBytes[frameLength - 1]) {
+        if (body[1] == RobotTelemetry.opcode &&
+            _telemetry.apply(body.sublist(3))) {
+          updated = true;
+        }
+        _binaryBytes.removeRange(0, frameLength);
+      } else {
+        _binaryBytes.removeAt(0); // Not a frame - resynchronise
+      }
+    }
+
+    if (updated) notifyListeners();
   }
 
   void _onConnectionLost() {
@@ -358,6 +434,7 @@ class BluetoothProvider extends ChangeNotifier {
     _connectionStateSubscription = null;
     _characteristicSubscription?.cancel();
     _characteristicSubscription = null;
+    _replyLine = '';
     debugPrint('HM-10 connection lost');
     notifyListeners();
   }
@@ -369,6 +446,7 @@ class BluetoothProvider extends ChangeNotifier {
     Future.delayed(Duration(seconds: 2), () {
       // Give a small delay for connection to stabilize, then sync
       _triggerScheduleSync();
+      sendBytes(BinaryCommands.telemetryRate(_telemetryRate));
     });
   }
 
@@ -389,6 +467,86 @@ class BluetoothProvider extends ChangeNotifier {
   }
 
   Future<bool> sendCommand(String command) async {
+    debugPrint('Sending command to HM-10: $command');
+    List<int> bytes = utf8.encode(command);
+
+    // Single packet (20 bytes max for HM-10 BLE), newline-terminated so the
+    // Arduino receiver can frame it; anything longer goes in chunks
+    if (bytes.length < 20) return sendBytes([...bytes, 10]);
+    debugPrint('Command too long (${bytes.length} bytes), chunking...');
+    return _sendCommandInChunks(command, bytes);
+  }
+
+  // Send long commands in chunks with proper reassembly markers
+  Future<bool> _sendCommandInChunks(String command, List<int> bytes) async {
+    const int chunkSize = 15; // Leave 5 bytes for framing and chunk metadata
+    const int maxChunks = 12; // Robot reassembly buffer holds 12 chunks
+
+    if (bytes.length > chunkSize * maxChunks) {
+      debugPrint('Command too long even for chunking: ${bytes.length} bytes');
+      return false;
+    }
+
+    int totalChunks = (bytes.length / chunkSize).ceil();
+    _chunkMessageId = (_chunkMessageId + 1) & 0xFF;
+    debugPrint(
+        'Splitting message $_chunkMessageId into $totalChunks chunks of max $chunkSize bytes each');
+
+    _pendingChunks = [];
+    for (int i = 0; i < totalChunks; i++) {
+      int start = i * chunkSize;
+      int end = (start + chunkSize < bytes.length)
+          ? start + chunkSize
+          : bytes.length;
+
+      // Frame header [magic, length] then chunk metadata:
+      // [0xA5, length, message_id, chunk_number, last_chunk_number, ...data]
+      List<int> chunk = bytes.sublist(start, end);
+      _pendingChunks.add([
+        _chunkFrameMagic,
+        chunk.length + 3,
+        _chunkMessageId,
+        i,
+        totalChunks - 1,
+        ...chunk
+      ]);
+    }
+
+    // The robot places chunks by index, so no pacing is needed between them
+    List<List<int>> frames = _pendingChunks;
+    for (int i = 0; i < totalChunks; i++) {
+      debugPrint(
+          'Sending chunk ${i + 1}/$totalChunks: ${frames[i].length} bytes');
+      if (!await sendBytes(frames[i])) return false;
+    }
+
+    debugPrint('Successfully sent chunked command: $command');
+    return true;
+  }
+
+  // Robot replies "CHUNK_NACK:<id>:<i>,<j>" for chunks it is missing and
+  // "CHUNK_ACK:<id>" once the whole message is in
+  Future<void> _handleChunkReply(String line) async {
+    List<String> parts = line.split(':');
+    if (parts.length < 2 || int.tryParse(parts[1]) != _chunkMessageId) return;
+
+    if (parts[0] == 'CHUNK_ACK') {
+      _pendingChunks = [];
+      return;
+    }
+    if (parts[0] != 'CHUNK_NACK' || parts.length < 3) return;
+
+    List<List<int>> frames = _pendingChunks;
+    for (String index in parts[2].split(',')) {
+      int? i = int.tryParse(index);
+      if (i == null || i >= frames.length) continue;
+      debugPrint('Resending chunk $i of message $_chunkMessageId');
+      await sendBytes(frames[i]);
+    }
+  }
+
+  // Send raw bytes (text commands above, or a binary command frame)
+  Future<bool> sendBytes(List<int> bytes) async {
     if (!isConnected || _writeCharacteristic == null) {
       debugPrint(
           'Cannot send command: not connected or no write characteristic');
@@ -407,9 +565,7 @@ class BluetoothProvider extends ChangeNotifier {
     }
 
     try {
-      // HM-10 typically doesn't need CRLF, but you can add \n if your Arduino expects it
-      List<int> bytes = utf8.encode(command);
-      debugPrint('Sending command to HM-10: $command (bytes: $bytes)');
+      debugPrint('Sending bytes to HM-10: $bytes');
 
       // Update last command time
       _lastCommandTime = DateTime.now();
@@ -417,12 +573,10 @@ class BluetoothProvider extends ChangeNotifier {
       // Use write with response since writeWithoutResponse is not supported
       if (_writeCharacteristic!.properties.write) {
         await _writeCharacteristic!.write(bytes, withoutResponse: false);
-        debugPrint(
-            'Command sent successfully to HM-10 with response: $command');
+        debugPrint('Command sent successfully to HM-10 with response');
       } else if (_writeCharacteristic!.properties.writeWithoutResponse) {
         await _writeCharacteristic!.write(bytes, withoutResponse: true);
-        debugPrint(
-            'Command sent successfully to HM-10 without response: $command');
+        debugPrint('Command sent successfully to HM-10 without response');
       } else {
         debugPrint('HM-10 characteristic does not support writing');
         return false;
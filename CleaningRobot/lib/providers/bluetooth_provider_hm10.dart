@@ -5,6 +5,14 @@ import 'package:flutter_blue_plus/flutter_blue_plus.dart';
 import 'package:permission_handler/permission_handler.dart';
 
 class BluetoothProvider extends ChangeNotifier {
+  // First byte of a binary chunk frame (text commands never start with it)
+  static const int _chunkFrameMagic = 0xA5;
+
+  // Chunked command being delivered: frames kept until the robot's
+  // CHUNK_ACK so chunks it reports missing (CHUNK_NACK) can be resent
+  int _chunkMessageId = 0;
+  List<List<int>> _pendingChunks = [];
+
   BluetoothDevice? _connectedDevice;
   BluetoothConnectionState _connectionState =
       BluetoothConnectionState.disconnected;
@@ -278,8 +286,11 @@ class BluetoothProvider extends ChangeNotifier {
 
   void _onDataReceived(List<int> data) {
     // Handle incoming data from robot (status updates, confirmations, etc.)
-    String message = utf8.decode(data);
+    String message = utf8.decode(data, allowMalformed: true);
     debugPrint('Received from HM-10: $message');
+    for (String line in message.split('\n')) {
+      if (line.startsWith('CHUNK_')) _handleChunkReply(line.trim());
+    }
     // This can be expanded to parse robot status and update other providers
   }
 
@@ -308,9 +319,10 @@ class BluetoothProvider extends ChangeNotifier {
       debugPrint('Sending command to HM-10: $command (bytes: $bytes)');
 
       // Check if command fits in single packet (20 bytes max for HM-10 BLE)
-      if (bytes.length <= 20) {
-        // Send as single packet
-        await _writeCharacteristic!.write(bytes, withoutResponse: true);
+      if (bytes.length < 20) {
+        // Send as single packet, newline-terminated so the Arduino can frame it
+        await _writeCharacteristic!
+            .write([...bytes, 10], withoutResponse: true);
         debugPrint('Command sent successfully to HM-10: $command');
         return true;
       } else {
@@ -328,8 +340,8 @@ class BluetoothProvider extends ChangeNotifier {
 
   // Send long commands in chunks with proper reassembly markers
   Future<bool> _sendCommandInChunks(String command, List<int> bytes) async {
-    const int chunkSize = 18; // Leave 2 bytes for chunk metadata
-    const int maxChunks = 9; // Limit to prevent excessive fragmentation
+    const int chunkSize = 15; // Leave 5 bytes for framing and chunk metadata
+    const int maxChunks = 12; // Robot reassembly buffer holds 12 chunks
 
     if (bytes.length > chunkSize * maxChunks) {
       debugPrint('Command too long even for chunking: ${bytes.length} bytes');
@@ -338,9 +350,11 @@ class BluetoothProvider extends ChangeNotifier {
 
     try {
       int totalChunks = (bytes.length / chunkSize).ceil();
+      _chunkMessageId = (_chunkMessageId + 1) & 0xFF;
       debugPrint(
-          'Splitting into $totalChunks chunks of max $chunkSize bytes each');
+          'Splitting message $_chunkMessageId into $totalChunks chunks of max $chunkSize bytes each');
 
+      _pendingChunks = [];
       for (int i = 0; i < totalChunks; i++) {
         int start = i * chunkSize;
         int end = (start + chunkSize < bytes.length)
@@ -349,19 +363,24 @@ class BluetoothProvider extends ChangeNotifier {
 
         List<int> chunk = bytes.sublist(start, end);
 
-        // Add chunk metadata: [chunk_number, total_chunks, ...data]
-        List<int> chunkWithMetadata = [i, totalChunks - 1, ...chunk];
+        // Frame header [magic, length] then chunk metadata:
+        // [0xA5, length, message_id, chunk_number, last_chunk_number, ...data]
+        _pendingChunks.add([
+          _chunkFrameMagic,
+          chunk.length + 3,
+          _chunkMessageId,
+          i,
+          totalChunks - 1,
+          ...chunk
+        ]);
+      }
 
+      // The robot places chunks by index, so no pacing is needed between them
+      for (int i = 0; i < totalChunks; i++) {
         debugPrint(
-            'Sending chunk ${i + 1}/$totalChunks: ${chunkWithMetadata.length} bytes');
-
+            'Sending chunk ${i + 1}/$totalChunks: ${_pendingChunks[i].length} bytes');
         await _writeCharacteristic!
-            .write(chunkWithMetadata, withoutResponse: true);
-
-        // Small delay between chunks to prevent overwhelming the receiver
-        if (i < totalChunks - 1) {
-          await Future.delayed(const Duration(milliseconds: 50));
-        }
+            .write(_pendingChunks[i], withoutResponse: true);
       }
 
       debugPrint('Successfully sent chunked command: $command');
@@ -372,6 +391,31 @@ class BluetoothProvider extends ChangeNotifier {
     }
   }
 
+  // Robot replies "CHUNK_NACK:<id>:<i>,<j>" for chunks it is missing and
+  // "CHUNK_ACK:<id>" once the whole message is in
+  Future<void> _handleChunkReply(String line) async {
+    List<String> parts = line.split(':');
+    if (parts.length < 2 || int.tryParse(parts[1]) != _chunkMessageId) return;
+
+    if (parts[0] == 'CHUNK_ACK') {
+      _pendingChunks = [];
+      return;
+    }
+    if (parts[0] != 'CHUNK_NACK' || parts.length < 3) return;
+
+    for (String index in parts[2].split(',')) {
+      int? i = int.tryParse(index);
+      if (i == null || i >= _pendingChunks.length) continue;
+      debugPrint('Resending chunk $i of message $_chunkMessageId');
+      try {
+        await _writeCharacteristic!
+            .write(_pendingChunks[i], withoutResponse: true);
+      } catch (e) {
+        debugPrint('Failed to resend chunk $i: $e');
+      }
+    }
+  }
+
   // Test HM-10 connection
   Future<bool> testConnection() async {
     if (!isConnected) return false;
@@ -38,23 +38,31 @@ class RobotControlProvider extends ChangeNotifier {
       String jsonCommand, BluetoothProvider bluetoothProvider) async {
     if (!bluetoothProvider.isConnected) return false;
 
-    bool success = await bluetoothProvider.sendCommand(jsonCommand);
+    Map<String, dynamic>? command;
+    try {
+      command = jsonDecode(jsonCommand);
+    } catch (e) {
+      print('Failed to parse command: $e');
+    }
+
+    // Plain moves go out as 6-byte binary frames for lower latency
+    bool success = command != null && command['a'] == 'mv'
+        ? await bluetoothProvider
+            .sendBytes(BinaryCommands.move(command['d'] as String))
+        : await bluetoothProvider.sendCommand(jsonCommand);
     if (success) {
       _lastCommand = jsonCommand;
       _lastCommandTime = DateTime.now();
 
-      // Parse the JSON command to determine if robot is moving
-      try {
-        final Map<String, dynamic> command = jsonDecode(jsonCommand);
-        if (command['action'] == 'move') {
-          _isMoving =
-              command['direction'] != 's'; // 's' is stop in abbreviated format
-        } else if (command['action'] == 'multi') {
-          _isMoving =
-              command['direction'] != null && command['direction'] != 's';
+      // Determine from the sent command if the robot is moving
+      if (command != null) {
+        if (command['a'] == 'mv' || command['action'] == 'move') {
+          final direction = command['d'] ?? command['direction'];
+          _isMoving = direction != 's'; // 's' is stop in abbreviated format
+        } else if (command['a'] == 'mu' || command['action'] == 'multi') {
+          final direction = command['d'] ?? command['direction'];
+          _isMoving = direction != null && direction != 's';
         }
-      } catch (e) {
-        print('Failed to parse sent command: $e');
       }
 
       if (_isMoving) {
@@ -180,6 +188,21 @@ class RobotControlProvider extends ChangeNotifier {
     return success;
   }
 
+  // Systematic lane-by-lane sweep instead of the random bounce
+  Future<bool> setCoverageMode(BluetoothProvider bluetoothProvider) async {
+    if (!bluetoothProvider.isConnected) return false;
+
+    bool success =
+        await bluetoothProvider.sendCommand(RobotCommands.coverageMode);
+    if (success) {
+      _status = _status.copyWith(state: RobotState.autonomous);
+      _lastCommand = RobotCommands.coverageMode;
+      _lastCommandTime = DateTime.now();
+      notifyListeners();
+    }
+    return success;
+  }
+
   Future<bool> toggleAutonomousMode(BluetoothProvider bluetoothProvider) async {
     if (!bluetoothProvider.isConnected) return false;
 
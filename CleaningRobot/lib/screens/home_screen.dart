@@ -335,6 +335,24 @@ class _HomeScreenState extends State<HomeScreen> {
                             );
                           },
                         ),
+                        if (robotProvider.status.state !=
+                            RobotState.autonomous)
+                          QuickActionButton(
+                            icon: Icons.grid_on,
+                            label: 'Coverage',
+                            color: Colors.teal,
+                            onPressed: () async {
+                              bool success = await robotProvider
+                                  .setCoverageMode(bluetoothProvider);
+                              _showToast(
+                                success
+                                    ? 'Coverage mode activated!'
+                                    : 'Failed to start coverage mode',
+                                isSuccess: success,
+                                isError: !success,
+                              );
+                            },
+                          ),
                         QuickActionButton(
                           icon: Icons.gamepad,
                           label: 'Manual',